@@ -7,6 +7,8 @@ def configure(env):
 def get_doc_classes():
 	return [
 		"SteamServer",
+		"SteamServerAuthTicket",
+		"SteamServerNetworkMessage",
 	]
 
 def get_doc_path():
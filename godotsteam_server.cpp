@@ -20,6 +20,13 @@
 #include "fstream"
 #include "vector"
 
+// Every queued unreliable message to a connection that has packing negotiated starts with an envelope byte: single messages follow it as-is,
+// packed messages follow it with frames of a little-endian u16 length and the message itself. Other connections never carry one.
+#define PACKED_MESSAGE_NONE -1
+#define PACKED_MESSAGE_SINGLE 0x00
+#define PACKED_MESSAGE_PACKED 0x01
+#define PACKED_MESSAGE_HEADER_SIZE 1
+
 
 ///// STEAM SINGLETON? STEAM SINGLETON
 /////////////////////////////////////////////////
@@ -42,6 +49,7 @@ SteamServer::SteamServer():
 	callbackClientGroupStatus(this, &SteamServer::client_group_status),
 	callbackAssociateClan(this, &SteamServer::associate_clan),
 	callbackPlayerCompat(this, &SteamServer::player_compat),
+	callbackValidateAuthTicketResponse(this, &SteamServer::validate_auth_ticket_response),
 
 	// Game Server Stat callbacks ///////////////
 	callbackStatsStored(this, &SteamServer::stats_stored),
@@ -82,13 +90,647 @@ SteamServer::SteamServer():
 	callbackUserSubscribedItemsListChanged(this, &SteamServer::user_subscribed_items_list_changed)
 {
 	is_init_success = false;
+	network_ring = NULL;
+	network_ring_capacity = 0;
+	network_thread_max_messages = 0;
+	network_thread_idle_usec = 0;
+	outbound_packing = false;
+	outbound_packed_size = 1100;
+	admission_enabled = false;
+	admission_max_connections = 0;
+	admission_max_attempts_per_ip = 0;
+	admission_max_attempts_per_steam_id = 0;
+	admission_rate_window = 10000000;
+	admission_last_prune = 0;
+	admission_poll_group = k_HSteamNetPollGroup_Invalid;
+	admission_end_reason = k_ESteamNetConnectionEnd_App_Generic;
+	connection_sampler_interval = 0;
+	connection_sampler_capacity = 0;
+	event_queue_enabled = false;
+	callback_thread_interval = 0;
+	callback_subsystems.set(CALLBACK_SUBSYSTEM_ALL);
+	callback_budget.set(0);
+	auth_session_pending_timeout = 0;
+	auth_session_end_on_disconnect = true;
+	query_socket_query_packets = 0;
+	query_socket_game_packets = 0;
+	query_socket_replies = 0;
+	query_socket_cached_replies = 0;
+	query_socket_challenges = 0;
+	query_socket_dropped = 0;
+	query_cache_enabled = false;
+	query_players_from_auth_sessions = false;
+	query_rate = 0.0;
+	query_burst = 0.0;
+	query_bucket_prune_usec = 0;
+	query_challenge_secret = 0;
+	query_info_player_offset = -1;
+	query_info_dirty = true;
+	query_info_steam_id = 0;
+	query_info_secure = false;
+	query_rules_dirty = true;
+	server_info_applied = 0;
+	server_info_suppressed = 0;
+	stats_buffer_enabled = false;
+	stats_flush_on_disconnect = false;
+	stats_flush_interval = 0;
+	stats_retry_delay = 0;
+	stats_retry_max_delay = 0;
+	stats_store_timeout = 0;
+	stats_buffer_writes = 0;
+	stats_buffer_coalesced = 0;
+	stats_buffer_stores = 0;
+	stats_buffer_store_failures = 0;
+	stats_buffer_store_timeouts = 0;
+	stats_buffer_flush_failures = 0;
 	singleton = this;
 }
 
 
+///// CALL RESULT LATENCY BUCKETS
+/////////////////////////////////////////////////
+//
+// Upper limits of the call result latency histogram buckets in microseconds; the last bucket takes everything slower
+const uint64_t SteamServer::CALL_RESULT_LATENCY_LIMITS[CALL_RESULT_LATENCY_BUCKETS - 1] = { 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000 };
+
+
+///// MANUAL DISPATCH TABLE
+/////////////////////////////////////////////////
+//
+// Callbacks handled by manual dispatch, matching the STEAM_GAMESERVER_CALLBACK list in the header; call results are dispatched through the call result pool instead
+const SteamServer::CallbackHandler SteamServer::CALLBACK_HANDLERS[] = {
+	{ SteamServerConnectFailure_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<SteamServerConnectFailure_t, &SteamServer::server_connect_failure> },
+	{ SteamServersConnected_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<SteamServersConnected_t, &SteamServer::server_connected> },
+	{ SteamServersDisconnected_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<SteamServersDisconnected_t, &SteamServer::server_disconnected> },
+	{ GSClientApprove_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<GSClientApprove_t, &SteamServer::client_approved> },
+	{ GSClientDeny_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<GSClientDeny_t, &SteamServer::client_denied> },
+	{ GSClientKick_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<GSClientKick_t, &SteamServer::client_kick> },
+	{ GSPolicyResponse_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<GSPolicyResponse_t, &SteamServer::policy_response> },
+	{ GSClientGroupStatus_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<GSClientGroupStatus_t, &SteamServer::client_group_status> },
+	{ AssociateWithClanResult_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<AssociateWithClanResult_t, &SteamServer::associate_clan> },
+	{ ComputeNewPlayerCompatibilityResult_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<ComputeNewPlayerCompatibilityResult_t, &SteamServer::player_compat> },
+	{ ValidateAuthTicketResponse_t::k_iCallback, CALLBACK_SUBSYSTEM_GAME_SERVER, &SteamServer::dispatchCallback<ValidateAuthTicketResponse_t, &SteamServer::validate_auth_ticket_response> },
+	{ GSStatsStored_t::k_iCallback, CALLBACK_SUBSYSTEM_STATS, &SteamServer::dispatchCallback<GSStatsStored_t, &SteamServer::stats_stored> },
+	{ GSStatsUnloaded_t::k_iCallback, CALLBACK_SUBSYSTEM_STATS, &SteamServer::dispatchCallback<GSStatsUnloaded_t, &SteamServer::stats_unloaded> },
+	{ HTTPRequestCompleted_t::k_iCallback, CALLBACK_SUBSYSTEM_HTTP, &SteamServer::dispatchCallback<HTTPRequestCompleted_t, &SteamServer::http_request_completed> },
+	{ HTTPRequestDataReceived_t::k_iCallback, CALLBACK_SUBSYSTEM_HTTP, &SteamServer::dispatchCallback<HTTPRequestDataReceived_t, &SteamServer::http_request_data_received> },
+	{ HTTPRequestHeadersReceived_t::k_iCallback, CALLBACK_SUBSYSTEM_HTTP, &SteamServer::dispatchCallback<HTTPRequestHeadersReceived_t, &SteamServer::http_request_headers_received> },
+	{ SteamInventoryDefinitionUpdate_t::k_iCallback, CALLBACK_SUBSYSTEM_INVENTORY, &SteamServer::dispatchCallback<SteamInventoryDefinitionUpdate_t, &SteamServer::inventory_definition_update> },
+	{ SteamInventoryFullUpdate_t::k_iCallback, CALLBACK_SUBSYSTEM_INVENTORY, &SteamServer::dispatchCallback<SteamInventoryFullUpdate_t, &SteamServer::inventory_full_update> },
+	{ SteamInventoryResultReady_t::k_iCallback, CALLBACK_SUBSYSTEM_INVENTORY, &SteamServer::dispatchCallback<SteamInventoryResultReady_t, &SteamServer::inventory_result_ready> },
+	{ P2PSessionConnectFail_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING, &SteamServer::dispatchCallback<P2PSessionConnectFail_t, &SteamServer::p2p_session_connect_fail> },
+	{ P2PSessionRequest_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING, &SteamServer::dispatchCallback<P2PSessionRequest_t, &SteamServer::p2p_session_request> },
+	{ SteamNetworkingMessagesSessionRequest_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING_MESSAGES, &SteamServer::dispatchCallback<SteamNetworkingMessagesSessionRequest_t, &SteamServer::network_messages_session_request> },
+	{ SteamNetworkingMessagesSessionFailed_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING_MESSAGES, &SteamServer::dispatchCallback<SteamNetworkingMessagesSessionFailed_t, &SteamServer::network_messages_session_failed> },
+	{ SteamNetConnectionStatusChangedCallback_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING_SOCKETS, &SteamServer::dispatchCallback<SteamNetConnectionStatusChangedCallback_t, &SteamServer::network_connection_status_changed> },
+	{ SteamNetAuthenticationStatus_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING_SOCKETS, &SteamServer::dispatchCallback<SteamNetAuthenticationStatus_t, &SteamServer::network_authentication_status> },
+	{ SteamNetworkingFakeIPResult_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING_SOCKETS, &SteamServer::dispatchCallback<SteamNetworkingFakeIPResult_t, &SteamServer::fake_ip_result> },
+	{ SteamRelayNetworkStatus_t::k_iCallback, CALLBACK_SUBSYSTEM_NETWORKING_UTILS, &SteamServer::dispatchCallback<SteamRelayNetworkStatus_t, &SteamServer::relay_network_status> },
+	{ RemoteStorageLocalFileChange_t::k_iCallback, CALLBACK_SUBSYSTEM_REMOTE_STORAGE, &SteamServer::dispatchCallback<RemoteStorageLocalFileChange_t, &SteamServer::local_file_changed> },
+	{ DownloadItemResult_t::k_iCallback, CALLBACK_SUBSYSTEM_UGC, &SteamServer::dispatchCallback<DownloadItemResult_t, &SteamServer::item_downloaded> },
+	{ ItemInstalled_t::k_iCallback, CALLBACK_SUBSYSTEM_UGC, &SteamServer::dispatchCallback<ItemInstalled_t, &SteamServer::item_installed> },
+	{ UserSubscribedItemsListChanged_t::k_iCallback, CALLBACK_SUBSYSTEM_UGC, &SteamServer::dispatchCallback<UserSubscribedItemsListChanged_t, &SteamServer::user_subscribed_items_list_changed> },
+	{ 0, CALLBACK_SUBSYSTEM_NONE, NULL }
+};
+
+
 ///// INTERNAL FUNCTIONS
 /////////////////////////////////////////////////
 //
+// Count an admission attempt for an IP or Steam ID and check it against its limit for the current window
+bool SteamServer::allowAdmissionAttempt(uint64_t key, int max_attempts, SteamNetworkingMicroseconds now) {
+	if (max_attempts <= 0) {
+		return true;
+	}
+	HashMap<uint64_t, AdmissionWindow>::Iterator window = admission_attempts.find(key);
+	if (!window) {
+		AdmissionWindow new_window;
+		new_window.start = now;
+		new_window.attempts = 0;
+		window = admission_attempts.insert(key, new_window);
+	}
+	else if (admission_rate_window > 0 && now - window->value.start >= admission_rate_window) {
+		window->value.start = now;
+		window->value.attempts = 0;
+	}
+	window->value.attempts++;
+	return window->value.attempts <= max_attempts;
+}
+
+// Run the admission policy on a new incoming connection, accepting or closing it right away. Returns false if it was rejected and closed
+bool SteamServer::admitConnection(uint32 connection_handle, const SteamNetConnectionInfo_t &info) {
+	SteamNetworkingMicroseconds now = SteamNetworkingUtils()->GetLocalTimestamp();
+	// Forget windows that have run out, every so often; a zero window never runs out
+	if (admission_rate_window > 0 && now - admission_last_prune >= admission_rate_window) {
+		LocalVector<uint64_t> expired_keys;
+		for (const KeyValue<uint64_t, AdmissionWindow> &window : admission_attempts) {
+			if (now - window.value.start >= admission_rate_window) {
+				expired_keys.push_back(window.key);
+			}
+		}
+		for (uint32 i = 0; i < expired_keys.size(); i++) {
+			admission_attempts.erase(expired_keys[i]);
+		}
+		admission_last_prune = now;
+	}
+	uint64_t steam_id = getSteamIDFromIdentity(info.m_identityRemote);
+	uint32 remote_ip = info.m_addrRemote.GetIPv4();
+	int reject_reason = -1;
+	if (steam_id != 0 && admission_bans.has(steam_id)) {
+		reject_reason = ADMISSION_REJECT_BANNED;
+	}
+	// IPs and Steam IDs share one table; IPs are tagged in the top bit, which no Steam ID uses
+	else if (remote_ip != 0 && !allowAdmissionAttempt(((uint64_t)1 << 63) | remote_ip, admission_max_attempts_per_ip, now)) {
+		reject_reason = ADMISSION_REJECT_RATE_LIMITED_IP;
+	}
+	else if (steam_id != 0 && !allowAdmissionAttempt(steam_id, admission_max_attempts_per_steam_id, now)) {
+		reject_reason = ADMISSION_REJECT_RATE_LIMITED_STEAM_ID;
+	}
+	// The registry already holds this connection
+	else if (admission_max_connections > 0 && connection_records.size() > (uint32)admission_max_connections) {
+		reject_reason = ADMISSION_REJECT_FULL;
+	}
+	if (reject_reason == -1 && SteamNetworkingSockets()->AcceptConnection((HSteamNetConnection)connection_handle) == k_EResultOK) {
+		if (admission_poll_group != k_HSteamNetPollGroup_Invalid) {
+			setConnectionPollGroup(connection_handle, admission_poll_group);
+		}
+		admission_accepted.push_back(connection_handle);
+		return true;
+	}
+	if (reject_reason == -1) {
+		reject_reason = ADMISSION_REJECT_ACCEPT_FAILED;
+	}
+	closeConnection(connection_handle, admission_end_reason, "Rejected by admission policy", false);
+	admission_rejected.push_back(connection_handle);
+	admission_reject_reasons.push_back(reject_reason);
+	return false;
+}
+
+// Give a connection an empty sample buffer; the sampler mutex must be held
+void SteamServer::addConnectionSamples(uint32 connection_handle) {
+	ConnectionSamples ring;
+	ring.samples.resize(connection_sampler_capacity);
+	ring.next = 0;
+	ring.count = 0;
+	connection_samples.insert(connection_handle, ring);
+}
+
+// Connection sampler thread body; Steam is queried without holding the sampler lock so readers are never stuck behind it
+void SteamServer::connection_sampler_loop(void *user_data) {
+	SteamServer *steam_server = (SteamServer *)user_data;
+	LocalVector<uint32> handles;
+	LocalVector<SteamNetConnectionRealTimeStatus_t> statuses;
+	LocalVector<bool> sampled;
+	while (steam_server->connection_sampler_running.is_set()) {
+		handles.clear();
+		steam_server->connection_sampler_mutex.lock();
+		for (const KeyValue<uint32, ConnectionSamples> &connection : steam_server->connection_samples) {
+			handles.push_back(connection.key);
+		}
+		steam_server->connection_sampler_mutex.unlock();
+		statuses.resize(handles.size());
+		sampled.resize(handles.size());
+		SteamNetworkingMicroseconds now = 0;
+		if (SteamNetworkingSockets() != NULL && SteamNetworkingUtils() != NULL) {
+			now = SteamNetworkingUtils()->GetLocalTimestamp();
+			for (uint32 i = 0; i < handles.size(); i++) {
+				sampled[i] = SteamNetworkingSockets()->GetConnectionRealTimeStatus((HSteamNetConnection)handles[i], &statuses[i], 0, NULL) == k_EResultOK;
+			}
+		}
+		else {
+			for (uint32 i = 0; i < handles.size(); i++) {
+				sampled[i] = false;
+			}
+		}
+		// Connections removed while Steam was being queried are simply skipped
+		steam_server->connection_sampler_mutex.lock();
+		for (uint32 i = 0; i < handles.size(); i++) {
+			if (!sampled[i]) {
+				continue;
+			}
+			ConnectionSamples *ring = steam_server->connection_samples.getptr(handles[i]);
+			if (ring == NULL) {
+				continue;
+			}
+			const SteamNetConnectionRealTimeStatus_t &this_status = statuses[i];
+			ConnectionSample &sample = ring->samples[ring->next];
+			sample.time = now;
+			sample.ping = this_status.m_nPing;
+			sample.local_quality = this_status.m_flConnectionQualityLocal;
+			sample.remote_quality = this_status.m_flConnectionQualityRemote;
+			sample.bytes_in_per_second = this_status.m_flInBytesPerSec;
+			sample.bytes_out_per_second = this_status.m_flOutBytesPerSec;
+			sample.queue_time = this_status.m_usecQueueTime;
+			ring->next = (ring->next + 1) % ring->samples.size();
+			if (ring->count < (int)ring->samples.size()) {
+				ring->count++;
+			}
+		}
+		steam_server->connection_sampler_mutex.unlock();
+		// Sleep in short slices so stopConnectionSampler does not wait out a whole interval
+		int slept = 0;
+		while (slept < steam_server->connection_sampler_interval && steam_server->connection_sampler_running.is_set()) {
+			int slice = MIN(steam_server->connection_sampler_interval - slept, THREAD_SLEEP_SLICE_USEC);
+			OS::get_singleton()->delay_usec(slice);
+			slept += slice;
+		}
+	}
+	SteamAPI_ReleaseCurrentThreadMemory();
+}
+
+// Add a callback to the event queue in place of its signal
+void SteamServer::queueEvent(EventType type, uint32 handle, uint64_t steam_id, int value, int old_value, int reason, uint64_t other_id) {
+	QueuedEvent event;
+	event.type = type;
+	event.handle = handle;
+	event.steam_id = steam_id;
+	event.value = value;
+	event.old_value = old_value;
+	event.reason = reason;
+	event.other_id = other_id;
+	event_queue.push_back(event);
+}
+
+// Callback thread body; runs the callbacks while holding the native table lock
+void SteamServer::callback_thread_loop(void *user_data) {
+	SteamServer *steam_server = (SteamServer *)user_data;
+	while (steam_server->callback_thread_running.is_set()) {
+		steam_server->callback_mutex.lock();
+		if (SteamGameServer() != NULL) {
+			steam_server->runSteamCallbacks();
+		}
+		steam_server->callback_mutex.unlock();
+		OS::get_singleton()->delay_usec(steam_server->callback_thread_interval);
+	}
+	SteamAPI_ReleaseCurrentThreadMemory();
+}
+
+// Emit every signal the callback thread has queued, in order, then the admission summary
+void SteamServer::dispatchCallbackSignals() {
+	// The ring holds everything older than the overflow list, so empty it first
+	uint32_t head = callback_signal_head.get();
+	uint32_t tail = callback_signal_tail.get();
+	while (head != tail) {
+		CallbackSignal *callback_signal = callback_signal_ring[head & (CALLBACK_SIGNAL_RING_SIZE - 1)];
+		head++;
+		callback_signal_head.set(head);
+		emitQueuedSignal(callback_signal);
+	}
+	if (callback_signal_overflowed.is_set()) {
+		LocalVector<CallbackSignal *> overflow;
+		callback_signal_overflow_mutex.lock();
+		overflow = callback_signal_overflow;
+		callback_signal_overflow.clear();
+		callback_signal_overflowed.clear();
+		callback_signal_overflow_mutex.unlock();
+		for (uint32 i = 0; i < overflow.size(); i++) {
+			emitQueuedSignal(overflow[i]);
+		}
+	}
+	emitAdmissionSummary();
+}
+
+// Report what the admission policy did since the last report
+void SteamServer::emitAdmissionSummary() {
+	callback_mutex.lock();
+	if (admission_accepted.size() == 0 && admission_rejected.size() == 0) {
+		callback_mutex.unlock();
+		return;
+	}
+	PackedInt32Array accepted;
+	accepted.resize(admission_accepted.size());
+	for (uint32 i = 0; i < admission_accepted.size(); i++) {
+		accepted.set(i, admission_accepted[i]);
+	}
+	PackedInt32Array rejected;
+	rejected.resize(admission_rejected.size());
+	PackedInt32Array reasons;
+	reasons.resize(admission_rejected.size());
+	for (uint32 i = 0; i < admission_rejected.size(); i++) {
+		rejected.set(i, admission_rejected[i]);
+		reasons.set(i, admission_reject_reasons[i]);
+	}
+	admission_accepted.clear();
+	admission_rejected.clear();
+	admission_reject_reasons.clear();
+	callback_mutex.unlock();
+	emit_signal("admission_summary", accepted, rejected, reasons);
+}
+
+// End auth sessions that have waited longer than the pending timeout for Steam to validate their ticket
+void SteamServer::expireAuthSessions() {
+	if (auth_session_pending_timeout == 0 || auth_sessions.is_empty()) {
+		return;
+	}
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	LocalVector<uint64_t> expired;
+	for (const KeyValue<uint64_t, AuthSession> &session : auth_sessions) {
+		if (session.value.state == AUTH_SESSION_STATE_PENDING && now - session.value.start_usec >= auth_session_pending_timeout) {
+			expired.push_back(session.key);
+		}
+	}
+	for (uint32 i = 0; i < expired.size(); i++) {
+		endTrackedAuthSession(expired[i]);
+		emitCallbackSignal("auth_session_timed_out", expired[i]);
+	}
+}
+
+// End a tracked auth session and cancel any tickets we gave that player; callback_mutex must be held
+void SteamServer::endTrackedAuthSession(uint64_t steam_id) {
+	if (SteamGameServer() == NULL) {
+		return;
+	}
+	if (auth_sessions.erase(steam_id)) {
+		SteamGameServer()->EndAuthSession(createSteamID(steam_id));
+	}
+	cancelTrackedAuthTickets(steam_id, false);
+	licence_cache.erase(steam_id);
+}
+
+// Push a player's buffered stats into Steam and ask for them to be stored; callback_mutex must be held
+void SteamServer::flushPlayerStats(uint64_t steam_id, StatsBuffer &buffer, uint64_t now) {
+	if (SteamGameServerStats() == NULL) {
+		return;
+	}
+	CSteamID userID = (uint64)steam_id;
+	for (const KeyValue<String, BufferedStat> &stat : buffer.stats) {
+		CharString name = stat.key.utf8();
+		bool set = false;
+		if (stat.value.type == BUFFERED_STAT_INT) {
+			set = SteamGameServerStats()->SetUserStat(userID, name.get_data(), stat.value.int_value);
+		}
+		else if (stat.value.type == BUFFERED_STAT_FLOAT) {
+			set = SteamGameServerStats()->SetUserStat(userID, name.get_data(), stat.value.float_value);
+		}
+		else {
+			set = SteamGameServerStats()->SetUserAchievement(userID, name.get_data());
+		}
+		// Writes were checked when buffered, so this only happens if the user's stats were unloaded since
+		if (!set) {
+			stats_buffer_flush_failures++;
+		}
+	}
+	buffer.stats.clear();
+	buffer.dirty = false;
+	buffer.storing = true;
+	buffer.last_store_usec = now;
+	SteamGameServerStats()->StoreUserStats(userID);
+	stats_buffer_stores++;
+}
+
+// Flush every player whose buffer has waited out the flush interval and any failure backoff, or every dirty player if forced.
+// A store that Steam has not answered within the store timeout is treated as failed and retried.
+void SteamServer::flushStatsBuffers(bool force) {
+	if (!stats_buffer_enabled || stats_buffers.is_empty()) {
+		return;
+	}
+	MutexLock lock(callback_mutex);
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	for (KeyValue<uint64_t, StatsBuffer> &buffer : stats_buffers) {
+		if (buffer.value.storing && stats_store_timeout > 0 && now - buffer.value.last_store_usec >= stats_store_timeout) {
+			stats_buffer_store_timeouts++;
+			retryStatsStore(buffer.value, now);
+		}
+		if (!buffer.value.dirty || buffer.value.storing) {
+			continue;
+		}
+		if (!force && (now - buffer.value.dirty_usec < stats_flush_interval || now < buffer.value.retry_usec)) {
+			continue;
+		}
+		flushPlayerStats(buffer.key, buffer.value, now);
+	}
+}
+
+// Give up on a player's store and try again once the backoff delay has passed; Steam still holds the values we set. callback_mutex must be held
+void SteamServer::retryStatsStore(StatsBuffer &buffer, uint64_t now) {
+	stats_buffer_store_failures++;
+	uint64_t delay = stats_retry_delay << MIN(buffer.failures, 16);
+	buffer.storing = false;
+	buffer.failures++;
+	buffer.retry_usec = now + MIN(delay, stats_retry_max_delay);
+	if (!buffer.dirty) {
+		buffer.dirty = true;
+		buffer.dirty_usec = buffer.last_store_usec;
+	}
+}
+
+// Get a player's stats buffer, marking it as having something to store; callback_mutex must be held
+SteamServer::StatsBuffer &SteamServer::getDirtyStatsBuffer(uint64_t steam_id) {
+	StatsBuffer *buffer = stats_buffers.getptr(steam_id);
+	if (buffer == NULL) {
+		buffer = &stats_buffers.insert(steam_id, StatsBuffer())->value;
+	}
+	if (!buffer->dirty) {
+		buffer->dirty = true;
+		buffer->dirty_usec = OS::get_singleton()->get_ticks_usec();
+	}
+	return *buffer;
+}
+
+// Absorb a stat or achievement write into a player's buffer, replacing any earlier write to the same name.
+// The first write to each name is checked with Steam; returns false if Steam does not know the name for that player.
+bool SteamServer::bufferStat(uint64_t steam_id, const String &name, const BufferedStat &stat) {
+	MutexLock lock(callback_mutex);
+	StatsBuffer *player_buffer = stats_buffers.getptr(steam_id);
+	if (player_buffer == NULL) {
+		player_buffer = &stats_buffers.insert(steam_id, StatsBuffer())->value;
+	}
+	const BufferedStatType *validated = player_buffer->validated.getptr(name);
+	if (validated == NULL || *validated != stat.type) {
+		if (!validateBufferedStat(steam_id, name, stat.type)) {
+			return false;
+		}
+		player_buffer->validated[name] = stat.type;
+	}
+	StatsBuffer &buffer = getDirtyStatsBuffer(steam_id);
+	BufferedStat *current = buffer.stats.getptr(name);
+	if (current != NULL) {
+		*current = stat;
+		stats_buffer_coalesced++;
+	}
+	else {
+		buffer.stats.insert(name, stat);
+	}
+	stats_buffer_writes++;
+	return true;
+}
+
+// Check that Steam has a stat or achievement of this type for the player, as a set would; callback_mutex must be held
+bool SteamServer::validateBufferedStat(uint64_t steam_id, const String &name, BufferedStatType type) {
+	CSteamID userID = (uint64)steam_id;
+	CharString name_utf8 = name.utf8();
+	if (type == BUFFERED_STAT_INT) {
+		int32 value = 0;
+		return SteamGameServerStats()->GetUserStat(userID, name_utf8.get_data(), &value);
+	}
+	if (type == BUFFERED_STAT_FLOAT) {
+		float value = 0.0;
+		return SteamGameServerStats()->GetUserStat(userID, name_utf8.get_data(), &value);
+	}
+	bool unlocked = false;
+	return SteamGameServerStats()->GetUserAchievement(userID, name_utf8.get_data(), &unlocked);
+}
+
+// Find a write still sitting in a player's stats buffer; callback_mutex must be held
+const SteamServer::BufferedStat *SteamServer::findBufferedStat(uint64_t steam_id, const String &name) {
+	StatsBuffer *buffer = stats_buffers.getptr(steam_id);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	return buffer->stats.getptr(name);
+}
+
+// Cancel every outstanding ticket, or only those made for one Steam ID; callback_mutex must be held
+int SteamServer::cancelTrackedAuthTickets(uint64_t remote_steam_id, bool all) {
+	if (SteamGameServer() == NULL || auth_tickets.is_empty()) {
+		return 0;
+	}
+	LocalVector<uint32> cancelled;
+	for (const KeyValue<uint32, uint64_t> &ticket : auth_tickets) {
+		if (all || ticket.value == remote_steam_id) {
+			cancelled.push_back(ticket.key);
+		}
+	}
+	for (uint32 i = 0; i < cancelled.size(); i++) {
+		SteamGameServer()->CancelAuthTicket(cancelled[i]);
+		auth_tickets.erase(cancelled[i]);
+	}
+	return cancelled.size();
+}
+
+// Find the manual dispatch entry for a callback ID
+const SteamServer::CallbackHandler *SteamServer::findCallbackHandler(const CallbackHandler *table, int callback_id) {
+	for (const CallbackHandler *entry = table; entry->dispatch != NULL; entry++) {
+		if (entry->callback_id == callback_id) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+// Take a completed call out of the pool and report it; it is freed once the callback run is over, as Steam may still be using it
+void SteamServer::finishCallResult(PendingCallResult *pending, bool io_failure) {
+	uint64_t latency = OS::get_singleton()->get_ticks_usec() - pending->issued_usec;
+	CallResultMetrics &metrics = call_result_metrics[pending->api_name];
+	if (metrics.in_flight > 0) {
+		metrics.in_flight--;
+	}
+	if (metrics.completed == 0 || latency < metrics.min_latency) {
+		metrics.min_latency = latency;
+	}
+	if (latency > metrics.max_latency) {
+		metrics.max_latency = latency;
+	}
+	metrics.completed++;
+	metrics.total_latency += latency;
+	if (io_failure) {
+		metrics.io_failures++;
+	}
+	int bucket = 0;
+	while (bucket < CALL_RESULT_LATENCY_BUCKETS - 1 && latency >= CALL_RESULT_LATENCY_LIMITS[bucket]) {
+		bucket++;
+	}
+	metrics.latency_buckets[bucket]++;
+	call_results.erase(pending->handle);
+	finished_call_results.push_back(pending);
+	emitCallbackSignal("call_result_completed", (uint64_t)pending->handle, String(pending->api_name), io_failure);
+}
+
+// Free completed call results, and optionally every call still in flight along with its in-flight count
+void SteamServer::freeCallResults(bool pending_too) {
+	for (uint32 i = 0; i < finished_call_results.size(); i++) {
+		memdelete(finished_call_results[i]);
+	}
+	finished_call_results.clear();
+	if (pending_too) {
+		for (KeyValue<uint64_t, PendingCallResult *> &pending : call_results) {
+			CallResultMetrics *metrics = call_result_metrics.getptr(pending.value->api_name);
+			if (metrics != NULL && metrics->in_flight > 0) {
+				metrics->in_flight--;
+			}
+			memdelete(pending.value);
+		}
+		call_results.clear();
+	}
+}
+
+// Run the Steamworks server API callbacks, walking the callback queue ourselves when manual dispatch is on.
+// Callbacks from disabled subsystems are freed without being handled. Once the budget runs out the rest stay queued for the next run.
+void SteamServer::runSteamCallbacks() {
+	if (!manual_dispatch_enabled.is_set()) {
+		SteamGameServer_RunCallbacks();
+		freeCallResults(false);
+		expireAuthSessions();
+		flushStatsBuffers(false);
+		return;
+	}
+	HSteamPipe pipe = SteamGameServer_GetHSteamPipe();
+	if (pipe == 0) {
+		return;
+	}
+	SteamAPI_ManualDispatch_RunFrame(pipe);
+	uint32_t subsystems = callback_subsystems.get();
+	uint64_t budget = callback_budget.get();
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	CallbackMsg_t callback;
+	while (SteamAPI_ManualDispatch_GetNextCallback(pipe, &callback)) {
+		if (callback.m_iCallback == SteamAPICallCompleted_t::k_iCallback) {
+			SteamAPICallCompleted_t *call_completed = (SteamAPICallCompleted_t *)callback.m_pubParam;
+			HashMap<uint64_t, PendingCallResult *>::Iterator pending = call_results.find(call_completed->m_hAsyncCall);
+			if (pending) {
+				uint8 *call_result = new uint8[call_completed->m_cubParam];
+				memset(call_result, 0, call_completed->m_cubParam);
+				bool io_failure = false;
+				if (!SteamAPI_ManualDispatch_GetAPICallResult(pipe, call_completed->m_hAsyncCall, call_result, call_completed->m_cubParam, call_completed->m_iCallback, &io_failure)) {
+					io_failure = true;
+				}
+				pending->value->dispatch(call_result, io_failure);
+				delete[] call_result;
+			}
+		}
+		else {
+			const CallbackHandler *handler = findCallbackHandler(CALLBACK_HANDLERS, callback.m_iCallback);
+			if (handler != NULL && (handler->subsystem & subsystems)) {
+				handler->dispatch(this, callback.m_pubParam, false);
+			}
+		}
+		SteamAPI_ManualDispatch_FreeLastCallback(pipe);
+		if (budget > 0 && OS::get_singleton()->get_ticks_usec() - start >= budget) {
+			break;
+		}
+	}
+	freeCallResults(false);
+	expireAuthSessions();
+	flushStatsBuffers(false);
+}
+
+// Emit a signal queued by the callback thread and free it
+void SteamServer::emitQueuedSignal(CallbackSignal *callback_signal) {
+	int argument_count = callback_signal->arguments.size();
+	const Variant **argument_pointers = (const Variant **)alloca(sizeof(Variant *) * MAX(argument_count, 1));
+	for (int i = 0; i < argument_count; i++) {
+		argument_pointers[i] = &callback_signal->arguments[i];
+	}
+	emit_signalp(callback_signal->name, argument_pointers, argument_count);
+	memdelete(callback_signal);
+}
+
+// Queue a signal raised on the callback thread for the main thread; falls back to a locked list if the ring is full so nothing is dropped
+void SteamServer::queueCallbackSignal(CallbackSignal *callback_signal) {
+	if (!callback_signal_overflowed.is_set()) {
+		uint32_t tail = callback_signal_tail.get();
+		if (tail - callback_signal_head.get() < CALLBACK_SIGNAL_RING_SIZE) {
+			callback_signal_ring[tail & (CALLBACK_SIGNAL_RING_SIZE - 1)] = callback_signal;
+			callback_signal_tail.set(tail + 1);
+			return;
+		}
+	}
+	// Once anything has overflowed, keep using the list until the main thread empties it, to keep signals in order
+	MutexLock lock(callback_signal_overflow_mutex);
+	callback_signal_overflow.push_back(callback_signal);
+	callback_signal_overflowed.set();
+}
+
 // Helper function to turn an array of options into an array of SteamNetworkingConfigValue_t structs
 const SteamNetworkingConfigValue_t *SteamServer::convertOptionsArray(Array options) {
 	// Get the number of option arrays in the array.
@@ -214,6 +856,95 @@ String SteamServer::getStringFromIP(uint32 ip_integer) {
 	return ip_address;
 }
 
+// Count the connections in the registry that are still live for a remote Steam ID
+int SteamServer::getLiveConnectionCount(uint64_t steam_id) {
+	HashMap<uint64_t, LocalVector<uint32>>::Iterator handles = connection_handles_by_steam_id.find(steam_id);
+	if (!handles) {
+		return 0;
+	}
+	int live = 0;
+	for (uint32 i = 0; i < handles->value.size(); i++) {
+		if (connection_records.has(handles->value[i])) {
+			live++;
+		}
+	}
+	return live;
+}
+
+// Drop a connection from the connection registry, releasing its player if that was their last connection. Used for every close, ours or the peer's; callback_mutex must be held
+void SteamServer::removeConnectionRecord(uint32 connection_handle) {
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(connection_handle);
+	if (!connection) {
+		return;
+	}
+	uint64_t steam_id = connection->value.steam_id;
+	removeSteamIDConnection(steam_id, connection_handle);
+	connection_records.remove(connection);
+	if (connection_sampler_running.is_set()) {
+		MutexLock lock(connection_sampler_mutex);
+		connection_samples.erase(connection_handle);
+	}
+	if (steam_id != 0 && getLiveConnectionCount(steam_id) == 0) {
+		releaseDisconnectedPlayer(steam_id);
+	}
+}
+
+// End the auth session and store the buffered stats of a player whose last connection is gone; callback_mutex must be held
+void SteamServer::releaseDisconnectedPlayer(uint64_t steam_id) {
+	if (auth_session_end_on_disconnect) {
+		endTrackedAuthSession(steam_id);
+	}
+	if (stats_buffer_enabled && stats_flush_on_disconnect) {
+		flushUserStats(steam_id);
+	}
+}
+
+// Add or refresh a connection in the connection registry from its latest connection info
+void SteamServer::updateConnectionRecord(uint32 connection_handle, const SteamNetConnectionInfo_t &info) {
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(connection_handle);
+	bool is_new = !connection;
+	if (is_new) {
+		ConnectionRecord new_record;
+		new_record.steam_id = 0;
+		new_record.poll_group = k_HSteamNetPollGroup_Invalid;
+		new_record.packing = false;
+		new_record.connect_time = SteamNetworkingUtils() != NULL ? SteamNetworkingUtils()->GetLocalTimestamp() : 0;
+		connection = connection_records.insert(connection_handle, new_record);
+		if (connection_sampler_running.is_set()) {
+			MutexLock lock(connection_sampler_mutex);
+			addConnectionSamples(connection_handle);
+		}
+	}
+	ConnectionRecord &record = connection->value;
+	uint64_t steam_id = getSteamIDFromIdentity(info.m_identityRemote);
+	if (is_new || steam_id != record.steam_id) {
+		if (!is_new) {
+			removeSteamIDConnection(record.steam_id, connection_handle);
+		}
+		if (steam_id != 0) {
+			connection_handles_by_steam_id[steam_id].push_back(connection_handle);
+		}
+	}
+	record.steam_id = steam_id;
+	record.state = info.m_eState;
+	record.listen_socket = info.m_hListenSocket;
+	record.user_data = info.m_nUserData;
+	record.remote_ip = info.m_addrRemote.GetIPv4();
+	record.remote_port = info.m_addrRemote.m_port;
+}
+
+// Take a connection out of its Steam ID's list of live connections, dropping the list once it is empty
+void SteamServer::removeSteamIDConnection(uint64_t steam_id, uint32 connection_handle) {
+	HashMap<uint64_t, LocalVector<uint32>>::Iterator handles = connection_handles_by_steam_id.find(steam_id);
+	if (!handles) {
+		return;
+	}
+	handles->value.erase(connection_handle);
+	if (handles->value.is_empty()) {
+		connection_handles_by_steam_id.remove(handles);
+	}
+}
+
 // Convert a Steam IP Address to a string
 String SteamServer::getStringFromSteamIP(SteamNetworkingIPAddr this_address) {
 	char this_ip[16];
@@ -221,6 +952,205 @@ String SteamServer::getStringFromSteamIP(SteamNetworkingIPAddr this_address) {
 	return String(this_ip);
 }
 
+// Copy a list of received messages into one struct-of-arrays dictionary and release them
+// With unpack, unreliable messages on connections with packing negotiated are split back into the messages they carry
+Dictionary SteamServer::packMessageBatch(SteamNetworkingMessage_t **messages, int message_count, bool unpack) {
+	Dictionary batch;
+	if (message_count < 0) {
+		message_count = 0;
+	}
+	// Read each message's envelope once, with a single lock for the whole batch
+	LocalVector<int> envelopes;
+	envelopes.resize(message_count);
+	for (int i = 0; i < message_count; i++) {
+		envelopes[i] = PACKED_MESSAGE_NONE;
+	}
+	if (unpack) {
+		MutexLock lock(callback_mutex);
+		for (int i = 0; i < message_count; i++) {
+			envelopes[i] = getPackedEnvelope(messages[i]);
+		}
+	}
+	// Size the payload once so every message is a single copy
+	int total_size = 0;
+	int entry_count = 0;
+	for (int i = 0; i < message_count; i++) {
+		const uint8_t *frame = (const uint8_t *)messages[i]->m_pData;
+		int remaining = messages[i]->m_cbSize;
+		int envelope = envelopes[i];
+		bool packed = envelope == PACKED_MESSAGE_PACKED;
+		if (envelope != PACKED_MESSAGE_NONE) {
+			frame += PACKED_MESSAGE_HEADER_SIZE;
+			remaining -= PACKED_MESSAGE_HEADER_SIZE;
+		}
+		// A plain message is a single frame covering the whole payload
+		do {
+			int frame_size = remaining;
+			if (packed) {
+				if (remaining < 2 || remaining - 2 < (frame[0] | (frame[1] << 8))) {
+					break;
+				}
+				frame_size = frame[0] | (frame[1] << 8);
+				frame += 2;
+				remaining -= 2;
+			}
+			total_size += frame_size;
+			entry_count++;
+			frame += frame_size;
+			remaining -= frame_size;
+		} while (packed);
+	}
+	PackedByteArray payload;
+	payload.resize(total_size);
+	PackedInt32Array offsets;
+	offsets.resize(entry_count);
+	PackedInt32Array sizes;
+	sizes.resize(entry_count);
+	PackedInt32Array connections;
+	connections.resize(entry_count);
+	PackedInt32Array channels;
+	channels.resize(entry_count);
+	PackedInt64Array identities;
+	identities.resize(entry_count);
+	PackedInt64Array message_numbers;
+	message_numbers.resize(entry_count);
+	PackedInt64Array time_received;
+	time_received.resize(entry_count);
+	uint8_t *payload_data = payload.ptrw();
+	int32_t *offsets_data = offsets.ptrw();
+	int32_t *sizes_data = sizes.ptrw();
+	int32_t *connections_data = connections.ptrw();
+	int32_t *channels_data = channels.ptrw();
+	int64_t *identities_data = identities.ptrw();
+	int64_t *message_numbers_data = message_numbers.ptrw();
+	int64_t *time_received_data = time_received.ptrw();
+	int offset = 0;
+	int entry = 0;
+	for (int i = 0; i < message_count; i++) {
+		SteamNetworkingMessage_t *message = messages[i];
+		const uint8_t *frame = (const uint8_t *)message->m_pData;
+		int remaining = message->m_cbSize;
+		int envelope = envelopes[i];
+		bool packed = envelope == PACKED_MESSAGE_PACKED;
+		if (envelope != PACKED_MESSAGE_NONE) {
+			frame += PACKED_MESSAGE_HEADER_SIZE;
+			remaining -= PACKED_MESSAGE_HEADER_SIZE;
+		}
+		uint64_t identity = getSteamIDFromIdentity(message->m_identityPeer);
+		do {
+			int frame_size = remaining;
+			if (packed) {
+				if (remaining < 2 || remaining - 2 < (frame[0] | (frame[1] << 8))) {
+					break;
+				}
+				frame_size = frame[0] | (frame[1] << 8);
+				frame += 2;
+				remaining -= 2;
+			}
+			if (frame_size > 0) {
+				memcpy(payload_data + offset, frame, frame_size);
+			}
+			offsets_data[entry] = offset;
+			sizes_data[entry] = frame_size;
+			connections_data[entry] = message->m_conn;
+			channels_data[entry] = message->m_nChannel;
+			identities_data[entry] = identity;
+			message_numbers_data[entry] = message->m_nMessageNumber;
+			time_received_data[entry] = message->m_usecTimeReceived;
+			offset += frame_size;
+			entry++;
+			frame += frame_size;
+			remaining -= frame_size;
+		} while (packed);
+		// Release the message
+		message->Release();
+	}
+	batch["count"] = entry_count;
+	batch["payload"] = payload;
+	batch["offsets"] = offsets;
+	batch["sizes"] = sizes;
+	batch["connections"] = connections;
+	batch["channels"] = channels;
+	batch["identities"] = identities;
+	batch["message_numbers"] = message_numbers;
+	batch["time_received"] = time_received;
+	return batch;
+}
+
+// Flush the outbound queue from a SceneTree frame signal
+void SteamServer::flush_queued_messages_on_frame() {
+	flushQueuedMessages();
+}
+
+// Read the envelope byte of an unreliable message on a connection with packing negotiated; anything else is plain. callback_mutex must be held
+int SteamServer::getPackedEnvelope(SteamNetworkingMessage_t *message) {
+	if (message->m_nFlags & k_nSteamNetworkingSend_Reliable) {
+		return PACKED_MESSAGE_NONE;
+	}
+	if (!isPackingConnection(message->m_conn)) {
+		return PACKED_MESSAGE_NONE;
+	}
+	if (message->m_cbSize < PACKED_MESSAGE_HEADER_SIZE) {
+		return PACKED_MESSAGE_NONE;
+	}
+	uint8_t envelope = ((const uint8_t *)message->m_pData)[0];
+	if (envelope == PACKED_MESSAGE_SINGLE || envelope == PACKED_MESSAGE_PACKED) {
+		return envelope;
+	}
+	return PACKED_MESSAGE_NONE;
+}
+
+// Has packing been negotiated for a connection with setConnectionPacking; callback_mutex must be held
+bool SteamServer::isPackingConnection(uint32 connection_handle) {
+	const ConnectionRecord *record = connection_records.getptr(connection_handle);
+	return record != NULL && record->packing;
+}
+
+// Hand a list of received messages over to network message objects without copying their payloads
+Array SteamServer::wrapMessageObjects(SteamNetworkingMessage_t **messages, int message_count) {
+	Array message_objects;
+	for (int i = 0; i < message_count; i++) {
+		Ref<SteamServerNetworkMessage> message_object;
+		message_object.instantiate();
+		// The object now owns the message and releases it when freed
+		message_object->setMessage(messages[i]);
+		message_objects.append(message_object);
+	}
+	return message_objects;
+}
+
+// Allocate an outgoing message that points at data's storage instead of copying it
+// Pass shared_payload to point several messages at the same holder; it is created on the first call
+SteamNetworkingMessage_t *SteamServer::allocateZeroCopyMessage(const PackedByteArray &data, SharedPayload **shared_payload) {
+	SharedPayload *holder = NULL;
+	if (shared_payload != NULL && *shared_payload != NULL) {
+		holder = *shared_payload;
+		holder->refcount.ref();
+	}
+	else {
+		holder = memnew(SharedPayload);
+		holder->data = data;
+		holder->refcount.init();
+		if (shared_payload != NULL) {
+			*shared_payload = holder;
+		}
+	}
+	SteamNetworkingMessage_t *message = SteamNetworkingUtils()->AllocateMessage(0);
+	message->m_pData = (void *)holder->data.ptr();
+	message->m_cbSize = holder->data.size();
+	message->m_pfnFreeData = free_shared_payload;
+	message->m_nUserData = (int64)(intptr_t)holder;
+	return message;
+}
+
+// Message free callback for payloads shared between messages; frees the payload when its last message is freed
+void SteamServer::free_shared_payload(SteamNetworkingMessage_t *message) {
+	SharedPayload *shared_payload = (SharedPayload *)(intptr_t)message->m_nUserData;
+	if (shared_payload->refcount.unref()) {
+		memdelete(shared_payload);
+	}
+}
+
 
 ///// MAIN FUNCTIONS
 /////////////////////////////////////////////////
@@ -283,12 +1213,222 @@ bool SteamServer::isServerSecure() {
 	return SteamGameServer_BSecure();
 }
 
+// Take every event queued since the last call, grouped by event type. Only types that had events are included.
+// Events are only queued while the event queue is enabled with setEventQueueEnabled.
+Dictionary SteamServer::pollEvents() {
+	MutexLock lock(callback_mutex);
+	Dictionary events;
+	int type_counts[EVENT_TYPE_COUNT] = {};
+	for (uint32 i = 0; i < event_queue.size(); i++) {
+		type_counts[event_queue[i].type]++;
+	}
+	// Size every array once, then fill them in queue order
+	PackedInt64Array identities[EVENT_TYPE_COUNT];
+	PackedInt32Array values[EVENT_TYPE_COUNT];
+	PackedInt32Array connections;
+	PackedInt32Array old_states;
+	PackedInt32Array end_reasons;
+	PackedInt64Array owner_ids;
+	for (int type = 0; type < EVENT_TYPE_COUNT; type++) {
+		identities[type].resize(type_counts[type]);
+		values[type].resize(type_counts[type]);
+	}
+	connections.resize(type_counts[EVENT_NETWORK_CONNECTION_STATUS_CHANGED]);
+	old_states.resize(type_counts[EVENT_NETWORK_CONNECTION_STATUS_CHANGED]);
+	end_reasons.resize(type_counts[EVENT_NETWORK_CONNECTION_STATUS_CHANGED]);
+	owner_ids.resize(type_counts[EVENT_CLIENT_APPROVED]);
+	int type_index[EVENT_TYPE_COUNT] = {};
+	for (uint32 i = 0; i < event_queue.size(); i++) {
+		const QueuedEvent &event = event_queue[i];
+		int index = type_index[event.type]++;
+		identities[event.type].set(index, event.steam_id);
+		values[event.type].set(index, event.value);
+		if (event.type == EVENT_NETWORK_CONNECTION_STATUS_CHANGED) {
+			connections.set(index, event.handle);
+			old_states.set(index, event.old_value);
+			end_reasons.set(index, event.reason);
+		}
+		else if (event.type == EVENT_CLIENT_APPROVED) {
+			owner_ids.set(index, event.other_id);
+		}
+	}
+	event_queue.clear();
+	if (type_counts[EVENT_NETWORK_CONNECTION_STATUS_CHANGED] > 0) {
+		Dictionary status_changes;
+		status_changes["count"] = type_counts[EVENT_NETWORK_CONNECTION_STATUS_CHANGED];
+		status_changes["connections"] = connections;
+		status_changes["identities"] = identities[EVENT_NETWORK_CONNECTION_STATUS_CHANGED];
+		status_changes["states"] = values[EVENT_NETWORK_CONNECTION_STATUS_CHANGED];
+		status_changes["old_states"] = old_states;
+		status_changes["end_reasons"] = end_reasons;
+		events["network_connection_status_changed"] = status_changes;
+	}
+	if (type_counts[EVENT_CLIENT_APPROVED] > 0) {
+		Dictionary approved;
+		approved["count"] = type_counts[EVENT_CLIENT_APPROVED];
+		approved["steam_ids"] = identities[EVENT_CLIENT_APPROVED];
+		approved["owner_ids"] = owner_ids;
+		events["client_approved"] = approved;
+	}
+	if (type_counts[EVENT_CLIENT_DENIED] > 0) {
+		Dictionary denied;
+		denied["count"] = type_counts[EVENT_CLIENT_DENIED];
+		denied["steam_ids"] = identities[EVENT_CLIENT_DENIED];
+		denied["reasons"] = values[EVENT_CLIENT_DENIED];
+		events["client_denied"] = denied;
+	}
+	if (type_counts[EVENT_CLIENT_KICK] > 0) {
+		Dictionary kicked;
+		kicked["count"] = type_counts[EVENT_CLIENT_KICK];
+		kicked["steam_ids"] = identities[EVENT_CLIENT_KICK];
+		kicked["reasons"] = values[EVENT_CLIENT_KICK];
+		events["client_kick"] = kicked;
+	}
+	if (type_counts[EVENT_P2P_SESSION_REQUEST] > 0) {
+		Dictionary p2p_requests;
+		p2p_requests["count"] = type_counts[EVENT_P2P_SESSION_REQUEST];
+		p2p_requests["remote_steam_ids"] = identities[EVENT_P2P_SESSION_REQUEST];
+		events["p2p_session_request"] = p2p_requests;
+	}
+	if (type_counts[EVENT_NETWORK_MESSAGES_SESSION_REQUEST] > 0) {
+		Dictionary session_requests;
+		session_requests["count"] = type_counts[EVENT_NETWORK_MESSAGES_SESSION_REQUEST];
+		session_requests["remote_steam_ids"] = identities[EVENT_NETWORK_MESSAGES_SESSION_REQUEST];
+		events["network_messages_session_request"] = session_requests;
+	}
+	return events;
+}
+
+// Run the Steamworks server API callbacks, then report what the admission policy did during them.
+// While the callback thread is running, this only hands its queued signals over to the main thread.
+void SteamServer::run_callbacks() {
+	if (callback_thread_running.is_set()) {
+		dispatchCallbackSignals();
+		return;
+	}
+	// Handlers expect the native table lock, the same as when they run on the callback thread
+	callback_mutex.lock();
+	runSteamCallbacks();
+	callback_mutex.unlock();
+	emitAdmissionSummary();
+}
+
+// Switch callback dispatch over to Steam's manual dispatch mode, so only the subsystems in the mask are handled and each run stops after budget_usec microseconds (0 for no limit).
+// Call this after serverInit. It cannot be switched back off for the rest of the session.
+bool SteamServer::enableManualDispatch(BitField<CallbackSubsystem> subsystems, int budget_usec) {
+	if (SteamGameServer_GetHSteamPipe() == 0) {
+		return false;
+	}
+	callback_subsystems.set((uint32_t)subsystems);
+	setCallbackBudget(budget_usec);
+	if (!manual_dispatch_enabled.is_set()) {
+		MutexLock lock(callback_mutex);
+		SteamAPI_ManualDispatch_Init();
+		manual_dispatch_enabled.set();
+	}
+	return true;
+}
+
+// Get latency, in-flight and failure counts for every API that has issued a call result, keyed by method name.
+Dictionary SteamServer::getCallResultMetrics() {
+	Dictionary metrics;
+	MutexLock lock(callback_mutex);
+	for (const KeyValue<StringName, CallResultMetrics> &api : call_result_metrics) {
+		const CallResultMetrics &this_api = api.value;
+		Dictionary api_metrics;
+		api_metrics["in_flight"] = this_api.in_flight;
+		api_metrics["completed"] = this_api.completed;
+		api_metrics["io_failures"] = this_api.io_failures;
+		api_metrics["min_latency"] = this_api.min_latency;
+		api_metrics["max_latency"] = this_api.max_latency;
+		api_metrics["average_latency"] = (this_api.completed > 0) ? this_api.total_latency / this_api.completed : 0;
+		PackedInt64Array histogram;
+		histogram.resize(CALL_RESULT_LATENCY_BUCKETS);
+		for (int i = 0; i < CALL_RESULT_LATENCY_BUCKETS; i++) {
+			histogram.set(i, this_api.latency_buckets[i]);
+		}
+		api_metrics["latency_histogram"] = histogram;
+		metrics[String(api.key)] = api_metrics;
+	}
+	return metrics;
+}
+
+// Get the subsystems whose callbacks are handled in manual dispatch mode.
+BitField<SteamServer::CallbackSubsystem> SteamServer::getCallbackSubsystems() {
+	return (int64_t)callback_subsystems.get();
+}
+
+// Clear the call result metrics, keeping the count of calls still in flight.
+void SteamServer::resetCallResultMetrics() {
+	MutexLock lock(callback_mutex);
+	for (KeyValue<StringName, CallResultMetrics> &api : call_result_metrics) {
+		uint32_t in_flight = api.value.in_flight;
+		api.value = CallResultMetrics();
+		api.value.in_flight = in_flight;
+	}
+}
+
+// Set how many microseconds each manual dispatch run may spend handling callbacks; 0 means no limit.
+void SteamServer::setCallbackBudget(int budget_usec) {
+	if (budget_usec < 0) {
+		budget_usec = 0;
+	}
+	callback_budget.set((uint32_t)budget_usec);
+}
+
+// Set which subsystems have their callbacks handled in manual dispatch mode; the rest are dropped.
+void SteamServer::setCallbackSubsystems(BitField<CallbackSubsystem> subsystems) {
+	callback_subsystems.set((uint32_t)subsystems);
+}
+
+// Run the Steamworks server API callbacks on a background thread every interval_usec microseconds, so they keep flowing while the main loop is stalled.
+// Signals raised by callbacks are queued and emitted on the main thread at the start of each frame, or whenever run_callbacks is called. Returns false if the thread is already running.
+bool SteamServer::startCallbackThread(int interval_usec) {
+	if (callback_thread_running.is_set() || interval_usec <= 0) {
+		return false;
+	}
+	callback_thread_interval = interval_usec;
+	callback_signal_head.set(0);
+	callback_signal_tail.set(0);
+	callback_signal_overflowed.clear();
+	callback_thread_running.set();
+	callback_thread.start(callback_thread_loop, this);
+	SceneTree *scene_tree = SceneTree::get_singleton();
+	if (scene_tree != NULL) {
+		Callable dispatch_callable = callable_mp(this, &SteamServer::dispatchCallbackSignals);
+		if (!scene_tree->is_connected("process_frame", dispatch_callable)) {
+			scene_tree->connect("process_frame", dispatch_callable);
+		}
+	}
+	return true;
+}
+
+// Stop the callback thread and emit anything it left queued. Callbacks go back to being run by run_callbacks.
+void SteamServer::stopCallbackThread() {
+	if (!callback_thread_running.is_set()) {
+		return;
+	}
+	callback_thread_running.clear();
+	callback_thread.wait_to_finish();
+	SceneTree *scene_tree = SceneTree::get_singleton();
+	if (scene_tree != NULL) {
+		Callable dispatch_callable = callable_mp(this, &SteamServer::dispatchCallbackSignals);
+		if (scene_tree->is_connected("process_frame", dispatch_callable)) {
+			scene_tree->disconnect("process_frame", dispatch_callable);
+		}
+	}
+	dispatchCallbackSignals();
+}
+
 // Initialize SteamGameServer client and interface objects, and set server properties which may not be changed.
 // After calling this function, you should set any additional server parameters, and then logOnAnonymous() or logOn().
 bool SteamServer::serverInit(const String& ip, uint16 game_port, uint16 query_port, ServerMode server_mode, const String& version_number) {
 	if (!SteamGameServer_Init(getIPFromString(ip), game_port, query_port, (EServerMode)server_mode, version_number.utf8().get_data())) {
 		return false;
 	}
+	server_info.version = version_number;
+	server_info.game_port = game_port;
+	query_info_dirty = true;
 	return true;
 }
 
@@ -299,6 +1439,11 @@ Dictionary SteamServer::serverInitEx(const String& ip, uint16 game_port, uint16
 	char error_message[STEAM_MAX_ERROR_MESSAGE] = "Server initialized successfully";
 	ESteamAPIInitResult initialize_result = k_ESteamAPIInitResult_FailedGeneric;
 	initialize_result = SteamGameServer_InitEx(getIPFromString(ip), game_port, query_port, (EServerMode)server_mode, version_number.utf8().get_data(), &error_message);
+	if (initialize_result == k_ESteamAPIInitResult_OK) {
+		server_info.version = version_number;
+		server_info.game_port = game_port;
+		query_info_dirty = true;
+	}
 
 	Dictionary server_initialize;
 	server_initialize["status"] = initialize_result;
@@ -314,7 +1459,35 @@ void SteamServer::serverReleaseCurrentThreadMemory() {
 
 // Shut down the server connection to Steam.
 void SteamServer::serverShutdown() {
+	// Nothing may call into the interfaces once they are gone
+	stopCallbackThread();
+	stopNetworkThread();
+	stopConnectionSampler();
+	{
+		// Calls still in flight will never complete once the server is gone
+		MutexLock lock(callback_mutex);
+		freeCallResults(true);
+	}
+	// Whatever is still buffered has to reach Steam before the interfaces go
+	flushUserStats(0);
+	cancelAllAuthTickets();
 	SteamGameServer_Shutdown();
+	stats_buffers.clear();
+	// Licences may change while the server is down, so nothing cached survives a restart
+	licence_cache.clear();
+	server_info = ServerInfoShadow();
+	query_info_dirty = true;
+	query_rules_dirty = true;
+}
+
+// Queue connection, client and session request callbacks as compact records for pollEvents instead of emitting a signal for each one.
+// Turning the queue off drops anything still in it.
+void SteamServer::setEventQueueEnabled(bool enabled) {
+	MutexLock lock(callback_mutex);
+	event_queue_enabled = enabled;
+	if (!enabled) {
+		event_queue.clear();
+	}
 }
 
 
@@ -337,6 +1510,10 @@ void SteamServer::setGameDescription(const String& description) {
 		return;
 	}
 	SteamGameServer()->SetGameDescription(description.utf8().get_data());
+	if (server_info.game_description != description) {
+		server_info.game_description = description;
+		query_info_dirty = true;
+	}
 }
 
 // If your game is a mod, pass the string that identifies it. Default is empty meaning the app is the original game.
@@ -345,6 +1522,10 @@ void SteamServer::setModDir(const String& mod_directory) {
 		return;
 	}
 	SteamGameServer()->SetModDir(mod_directory.utf8().get_data());
+	if (server_info.mod_dir != mod_directory) {
+		server_info.mod_dir = mod_directory;
+		query_info_dirty = true;
+	}
 }
 
 // Is this a dedicated server? Default is false.
@@ -353,6 +1534,10 @@ void SteamServer::setDedicatedServer(bool dedicated) {
 		return;
 	}
 	SteamGameServer()->SetDedicatedServer(dedicated);
+	if (server_info.dedicated != dedicated) {
+		server_info.dedicated = dedicated;
+		query_info_dirty = true;
+	}
 }
 
 // NOTE: The following are login functions.
@@ -420,6 +1605,11 @@ void SteamServer::setMaxPlayerCount(int players_max) {
 		return;
 	}
 	SteamGameServer()->SetMaxPlayerCount(players_max);
+	server_info.pushed |= SERVER_INFO_MAX_PLAYERS;
+	if (server_info.max_players != players_max) {
+		server_info.max_players = players_max;
+		query_info_dirty = true;
+	}
 }
 
 // Number of bots. Default is zero.
@@ -428,6 +1618,11 @@ void SteamServer::setBotPlayerCount(int bots) {
 		return;
 	}
 	SteamGameServer()->SetBotPlayerCount(bots);
+	server_info.pushed |= SERVER_INFO_BOT_PLAYERS;
+	if (server_info.bot_players != bots) {
+		server_info.bot_players = bots;
+		query_info_dirty = true;
+	}
 }
 
 // Set the naem of the server as it will appear in the server browser.
@@ -436,6 +1631,11 @@ void SteamServer::setServerName(const String& name) {
 		return;
 	}
 	SteamGameServer()->SetServerName(name.utf8().get_data());
+	server_info.pushed |= SERVER_INFO_SERVER_NAME;
+	if (server_info.server_name != name) {
+		server_info.server_name = name;
+		query_info_dirty = true;
+	}
 }
 
 // Set name of map to report in server browser.
@@ -444,6 +1644,11 @@ void SteamServer::setMapName(const String& map) {
 		return;
 	}
 	SteamGameServer()->SetMapName(map.utf8().get_data());
+	server_info.pushed |= SERVER_INFO_MAP_NAME;
+	if (server_info.map_name != map) {
+		server_info.map_name = map;
+		query_info_dirty = true;
+	}
 }
 
 // Let people know if your server requires a password.
@@ -452,6 +1657,11 @@ void SteamServer::setPasswordProtected(bool password_protected) {
 		return;
 	}
 	SteamGameServer()->SetPasswordProtected(password_protected);
+	server_info.pushed |= SERVER_INFO_PASSWORD_PROTECTED;
+	if (server_info.password_protected != password_protected) {
+		server_info.password_protected = password_protected;
+		query_info_dirty = true;
+	}
 }
 
 // Spectator server. Default is zero, meaning it is now used.
@@ -460,6 +1670,8 @@ void SteamServer::setSpectatorPort(uint16 port) {
 		return;
 	}
 	SteamGameServer()->SetSpectatorPort(port);
+	server_info.pushed |= SERVER_INFO_SPECTATOR_PORT;
+	server_info.spectator_port = port;
 }
 
 // Name of spectator server. Only used if spectator port is non-zero.
@@ -468,6 +1680,8 @@ void SteamServer::setSpectatorServerName(const String& name) {
 		return;
 	}
 	SteamGameServer()->SetSpectatorServerName(name.utf8().get_data());
+	server_info.pushed |= SERVER_INFO_SPECTATOR_SERVER_NAME;
+	server_info.spectator_server_name = name;
 }
 
 // Call this to clear the whole list of key/values that are sent in rule queries.
@@ -476,6 +1690,11 @@ void SteamServer::clearAllKeyValues() {
 		return;
 	}
 	SteamGameServer()->ClearAllKeyValues();
+	server_info.pushed |= SERVER_INFO_KEY_VALUES;
+	if (!server_info.key_values.is_empty()) {
+		server_info.key_values.clear();
+		query_rules_dirty = true;
+	}
 }
 
 // Call this to add/update a key/value pair.
@@ -484,6 +1703,11 @@ void SteamServer::setKeyValue(const String& key, const String& value) {
 		return;
 	}
 	SteamGameServer()->SetKeyValue(key.utf8().get_data(), value.utf8().get_data());
+	String *current = server_info.key_values.getptr(key);
+	if (current == NULL || *current != value) {
+		server_info.key_values[key] = value;
+		query_rules_dirty = true;
+	}
 }
 
 // Set a string defining game tags for this server; optional. Allows users to filter in matchmaking/server browser.
@@ -492,6 +1716,11 @@ void SteamServer::setGameTags(const String& tags) {
 		return;
 	}
 	SteamGameServer()->SetGameTags(tags.utf8().get_data());
+	server_info.pushed |= SERVER_INFO_GAME_TAGS;
+	if (server_info.game_tags != tags) {
+		server_info.game_tags = tags;
+		query_info_dirty = true;
+	}
 }
 
 // Set a string defining game data for this server; optional. Allows users to filter in matchmaking/server browser.
@@ -500,6 +1729,8 @@ void SteamServer::setGameData(const String& data) {
 		return;
 	}
 	SteamGameServer()->SetGameData(data.utf8().get_data());
+	server_info.pushed |= SERVER_INFO_GAME_DATA;
+	server_info.game_data = data;
 }
 
 // Region identifier; optional. Default is empty meaning 'world'.
@@ -508,6 +1739,161 @@ void SteamServer::setRegion(const String& region) {
 		return;
 	}
 	SteamGameServer()->SetRegion(region.utf8().get_data());
+	server_info.pushed |= SERVER_INFO_REGION;
+	server_info.region = region;
+}
+
+// Push several server info fields at once, only calling the Steam setters for fields that differ from the last values pushed. Returns how many setters were called.
+// key_values replaces the whole rule list; rules left out of it are removed.
+int SteamServer::setServerInfo(Dictionary info) {
+	if (SteamGameServer() == NULL) {
+		return 0;
+	}
+	uint64_t applied = 0;
+	uint64_t suppressed = 0;
+	if (info.has("server_name")) {
+		String name = info["server_name"];
+		if (serverInfoChanged(SERVER_INFO_SERVER_NAME, server_info.server_name != name)) {
+			setServerName(name);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("map_name")) {
+		String map = info["map_name"];
+		if (serverInfoChanged(SERVER_INFO_MAP_NAME, server_info.map_name != map)) {
+			setMapName(map);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("max_players")) {
+		int players_max = info["max_players"];
+		if (serverInfoChanged(SERVER_INFO_MAX_PLAYERS, server_info.max_players != players_max)) {
+			setMaxPlayerCount(players_max);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("bot_players")) {
+		int bots = info["bot_players"];
+		if (serverInfoChanged(SERVER_INFO_BOT_PLAYERS, server_info.bot_players != bots)) {
+			setBotPlayerCount(bots);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	// Only kept for cached query replies; Steam counts players itself
+	if (info.has("players")) {
+		server_info.players = info["players"];
+	}
+	if (info.has("password_protected")) {
+		bool password_protected = info["password_protected"];
+		if (serverInfoChanged(SERVER_INFO_PASSWORD_PROTECTED, server_info.password_protected != password_protected)) {
+			setPasswordProtected(password_protected);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("game_tags")) {
+		String tags = info["game_tags"];
+		if (serverInfoChanged(SERVER_INFO_GAME_TAGS, server_info.game_tags != tags)) {
+			setGameTags(tags);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("game_data")) {
+		String data = info["game_data"];
+		if (serverInfoChanged(SERVER_INFO_GAME_DATA, server_info.game_data != data)) {
+			setGameData(data);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("region")) {
+		String region = info["region"];
+		if (serverInfoChanged(SERVER_INFO_REGION, server_info.region != region)) {
+			setRegion(region);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("spectator_port")) {
+		uint16 port = (uint16)(int)info["spectator_port"];
+		if (serverInfoChanged(SERVER_INFO_SPECTATOR_PORT, server_info.spectator_port != port)) {
+			setSpectatorPort(port);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("spectator_server_name")) {
+		String name = info["spectator_server_name"];
+		if (serverInfoChanged(SERVER_INFO_SPECTATOR_SERVER_NAME, server_info.spectator_server_name != name)) {
+			setSpectatorServerName(name);
+			applied++;
+		}
+		else {
+			suppressed++;
+		}
+	}
+	if (info.has("key_values")) {
+		Dictionary key_values = info["key_values"];
+		// Steam cannot remove a single rule, so start over if any rule we pushed is missing
+		bool removed = false;
+		for (const KeyValue<String, String> &rule : server_info.key_values) {
+			if (!key_values.has(rule.key)) {
+				removed = true;
+				break;
+			}
+		}
+		if (removed || !(server_info.pushed & SERVER_INFO_KEY_VALUES)) {
+			clearAllKeyValues();
+			applied++;
+		}
+		Array keys = key_values.keys();
+		for (int i = 0; i < keys.size(); i++) {
+			String key = keys[i];
+			String value = key_values[keys[i]];
+			String *current = server_info.key_values.getptr(key);
+			if (current == NULL || *current != value) {
+				setKeyValue(key, value);
+				applied++;
+			}
+			else {
+				suppressed++;
+			}
+		}
+	}
+	server_info_applied += applied;
+	server_info_suppressed += suppressed;
+	return applied;
+}
+
+// Get how many server info updates setServerInfo has passed to Steam or skipped because nothing changed.
+Dictionary SteamServer::getServerInfoStats() {
+	Dictionary stats;
+	stats["applied"] = server_info_applied;
+	stats["suppressed"] = server_info_suppressed;
+	return stats;
 }
 
 // NOTE: These functions are player list management / authentication.
@@ -521,13 +1907,17 @@ Dictionary SteamServer::getAuthSessionTicket(uint64_t remote_steam_id) {
 		uint32_t ticket_size = 1024;
 		PackedByteArray buffer;
 		buffer.resize(ticket_size);
-		if (remote_steam_id == 0) {
+		if (remote_steam_id != 0) {
 			SteamNetworkingIdentity auth_identity = getIdentityFromSteamID(remote_steam_id);
 			id = SteamGameServer()->GetAuthSessionTicket(buffer.ptrw(), ticket_size, &ticket_size, &auth_identity);
 		}
 		else{
 			id = SteamGameServer()->GetAuthSessionTicket(buffer.ptrw(), ticket_size, &ticket_size, NULL);
 		}
+		if (id != k_HAuthTicketInvalid) {
+			MutexLock lock(callback_mutex);
+			auth_tickets.insert(id, remote_steam_id);
+		}
 		// Add this data to the dictionary
 		auth_ticket["id"] = id;
 		auth_ticket["buffer"] = buffer;
@@ -536,37 +1926,160 @@ Dictionary SteamServer::getAuthSessionTicket(uint64_t remote_steam_id) {
 	return auth_ticket;
 }
 
+// Write a new auth session ticket into a reusable ticket object instead of allocating a buffer and dictionary for each one.
+bool SteamServer::getAuthSessionTicketInto(Ref<SteamServerAuthTicket> ticket, uint64_t remote_steam_id) {
+	if (SteamGameServer() == NULL || ticket.is_null()) {
+		return false;
+	}
+	uint32_t ticket_size = 0;
+	HAuthTicket id;
+	if (remote_steam_id != 0) {
+		SteamNetworkingIdentity auth_identity = getIdentityFromSteamID(remote_steam_id);
+		id = SteamGameServer()->GetAuthSessionTicket(ticket->getWriteBuffer(), SteamServerAuthTicket::TICKET_CAPACITY, &ticket_size, &auth_identity);
+	}
+	else {
+		id = SteamGameServer()->GetAuthSessionTicket(ticket->getWriteBuffer(), SteamServerAuthTicket::TICKET_CAPACITY, &ticket_size, NULL);
+	}
+	if (id == k_HAuthTicketInvalid) {
+		ticket->setTicket(k_HAuthTicketInvalid, 0, 0);
+		return false;
+	}
+	ticket->setTicket(id, ticket_size, remote_steam_id);
+	MutexLock lock(callback_mutex);
+	auth_tickets.insert(id, remote_steam_id);
+	return true;
+}
+
 // Authenticate the ticket from the entity Steam ID to be sure it is valid and isn't reused.
 uint32 SteamServer::beginAuthSession(PackedByteArray ticket, int ticket_size, uint64_t steam_id) {
 	if (SteamGameServer() == NULL) {
 		return -1;
 	}
 	CSteamID authSteamID = createSteamID(steam_id);
-	return SteamGameServer()->BeginAuthSession(ticket.ptr(), ticket_size, authSteamID);
+	MutexLock lock(callback_mutex);
+	EBeginAuthSessionResult result = SteamGameServer()->BeginAuthSession(ticket.ptr(), ticket_size, authSteamID);
+	// Track the session natively until Steam validates the ticket
+	if (result == k_EBeginAuthSessionResultOK) {
+		AuthSession session;
+		session.state = AUTH_SESSION_STATE_PENDING;
+		session.owner_id = 0;
+		session.response = k_EAuthSessionResponseOK;
+		session.start_usec = OS::get_singleton()->get_ticks_usec();
+		auth_sessions.insert(steam_id, session);
+	}
+	return result;
 }
 
 // Stop tracking started by beginAuthSession; called when no longer playing game with this entity;
 void SteamServer::endAuthSession(uint64_t steam_id) {
 	if (SteamGameServer() != NULL) {
 		CSteamID authSteamID = createSteamID(steam_id);
+		MutexLock lock(callback_mutex);
 		SteamGameServer()->EndAuthSession(authSteamID);
+		auth_sessions.erase(steam_id);
+		cancelTrackedAuthTickets(steam_id, false);
+		licence_cache.erase(steam_id);
+	}
+}
+
+// Get every tracked auth session as parallel packed arrays, along with how many are in each state.
+Dictionary SteamServer::getAuthSessions() {
+	Dictionary sessions;
+	PackedInt64Array steam_ids;
+	PackedInt64Array owner_ids;
+	PackedInt32Array states;
+	PackedInt32Array responses;
+	PackedInt64Array ages;
+	PackedInt64Array pending;
+	int state_counts[AUTH_SESSION_STATE_DENIED + 1] = { 0, 0, 0 };
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	MutexLock lock(callback_mutex);
+	for (const KeyValue<uint64_t, AuthSession> &session : auth_sessions) {
+		steam_ids.push_back(session.key);
+		owner_ids.push_back(session.value.owner_id);
+		states.push_back(session.value.state);
+		responses.push_back(session.value.response);
+		ages.push_back(now - session.value.start_usec);
+		state_counts[session.value.state]++;
+		if (session.value.state == AUTH_SESSION_STATE_PENDING) {
+			pending.push_back(session.key);
+		}
 	}
+	sessions["count"] = steam_ids.size();
+	sessions["pending_count"] = state_counts[AUTH_SESSION_STATE_PENDING];
+	sessions["approved_count"] = state_counts[AUTH_SESSION_STATE_APPROVED];
+	sessions["denied_count"] = state_counts[AUTH_SESSION_STATE_DENIED];
+	sessions["steam_ids"] = steam_ids;
+	sessions["owner_ids"] = owner_ids;
+	sessions["states"] = states;
+	sessions["responses"] = responses;
+	sessions["ages"] = ages;
+	sessions["pending"] = pending;
+	return sessions;
+}
+
+// Set how tracked auth sessions are cleaned up: pending_timeout in seconds (0 to wait forever) and whether to end a session once its player's last connection closes, which is on by default.
+void SteamServer::setAuthSessionPolicy(Dictionary policy) {
+	MutexLock lock(callback_mutex);
+	double pending_timeout = policy.get("pending_timeout", 0.0);
+	auth_session_pending_timeout = (uint64_t)(MAX(pending_timeout, 0.0) * 1000000.0);
+	auth_session_end_on_disconnect = policy.get("end_on_disconnect", true);
 }
 
 // Cancel auth ticket from getAuthSessionTicket; called when no longer playing game with the entity you gave the ticket to.
 void SteamServer::cancelAuthTicket(uint32_t auth_ticket) {
 	if (SteamGameServer() != NULL) {
 		SteamGameServer()->CancelAuthTicket(auth_ticket);
+		MutexLock lock(callback_mutex);
+		auth_tickets.erase(auth_ticket);
 	}
 }
 
+// Cancel every auth ticket that has not been cancelled yet. Returns how many were cancelled.
+int SteamServer::cancelAllAuthTickets() {
+	MutexLock lock(callback_mutex);
+	return cancelTrackedAuthTickets(0, true);
+}
+
+// Cancel every outstanding auth ticket made for one Steam ID. Returns how many were cancelled.
+int SteamServer::cancelAuthTicketsFor(uint64_t remote_steam_id) {
+	MutexLock lock(callback_mutex);
+	return cancelTrackedAuthTickets(remote_steam_id, false);
+}
+
 // After receiving a user's authentication data, and passing it to sendUserConnectAndAuthenticate, use to determine if user owns DLC
 int SteamServer::userHasLicenceForApp(uint64_t steam_id, uint32 app_id) {
 	if (SteamGameServer() == NULL) {
 		return 0;
 	}
-	CSteamID userID = (uint64)steam_id;
-	return SteamGameServer()->UserHasLicenseForApp(userID, (AppId_t)app_id);
+	MutexLock lock(callback_mutex);
+	return getLicenceResult(steam_id, app_id);
+}
+
+// Check a list of apps for one user at once, going through the licence cache; the results are in the same order as app_ids.
+PackedInt32Array SteamServer::userHasLicencesForApps(uint64_t steam_id, PackedInt32Array app_ids) {
+	PackedInt32Array results;
+	if (SteamGameServer() == NULL) {
+		return results;
+	}
+	results.resize(app_ids.size());
+	int32_t *result_list = results.ptrw();
+	MutexLock lock(callback_mutex);
+	for (int i = 0; i < app_ids.size(); i++) {
+		result_list[i] = getLicenceResult(steam_id, (uint32)app_ids[i]);
+	}
+	return results;
+}
+
+// Forget cached licence results for one user, or for everyone if steam_id is 0.
+void SteamServer::clearLicenceCache(uint64_t steam_id) {
+	MutexLock lock(callback_mutex);
+	if (steam_id == 0) {
+		licence_cache.clear();
+	}
+	else {
+		licence_cache.erase(steam_id);
+	}
 }
 
 // Ask if user is in specified group; results returned by GSUserGroupStatus_t.
@@ -595,6 +2108,197 @@ Dictionary SteamServer::handleIncomingPacket(int packet, const String& ip, uint1
 	return result;
 }
 
+// Hand a batch of query packets received on the game socket to the master server updater when in GameSocketShare mode.
+// Packet i runs from offsets[i] to offsets[i + 1], or to the end of data for the last one; ips are IPv4 addresses in host order. Returns how many packets Steam accepted.
+int SteamServer::handleIncomingPackets(const PackedByteArray data, PackedInt32Array offsets, PackedInt32Array ips, PackedInt32Array ports) {
+	int packet_count = offsets.size();
+	if (SteamGameServer() == NULL || packet_count == 0 || ips.size() != packet_count || ports.size() != packet_count) {
+		return 0;
+	}
+	const uint8_t *payload = data.ptr();
+	const int32_t *offset_list = offsets.ptr();
+	const int32_t *ip_list = ips.ptr();
+	const int32_t *port_list = ports.ptr();
+	int data_size = data.size();
+	int handled = 0;
+	for (int i = 0; i < packet_count; i++) {
+		int start = offset_list[i];
+		int end = (i + 1 < packet_count) ? offset_list[i + 1] : data_size;
+		if (start < 0 || end > data_size || end <= start) {
+			continue;
+		}
+		if (SteamGameServer()->HandleIncomingPacket(payload + start, end - start, (uint32)ip_list[i], (uint16)port_list[i])) {
+			handled++;
+		}
+	}
+	return handled;
+}
+
+// Own the shared game / query UDP socket natively in GameSocketShare mode. Datagrams bigger than max_packet_size are dropped and counted. Returns false if the socket could not be opened.
+bool SteamServer::openQuerySocket(uint16 port, const String& bind_ip, int batch_size, int max_packet_size) {
+	uint32 ip = bind_ip.is_empty() ? 0 : getIPFromString(bind_ip);
+	query_socket_query_packets = 0;
+	query_socket_game_packets = 0;
+	query_socket_replies = 0;
+	query_socket_cached_replies = 0;
+	query_socket_challenges = 0;
+	query_socket_dropped = 0;
+	query_buckets.clear();
+	// Challenges are only as hard to forge as the secret is to guess
+	if (OS::get_singleton()->get_entropy((uint8_t *)&query_challenge_secret, sizeof(query_challenge_secret)) != OK) {
+		query_challenge_secret = (uint32_t)Math::rand() ^ (uint32_t)OS::get_singleton()->get_ticks_usec();
+	}
+	return query_socket.openSocket(ip, port, batch_size, max_packet_size);
+}
+
+// Close the native query socket.
+void SteamServer::closeQuerySocket() {
+	query_socket.closeSocket();
+}
+
+// Receive everything waiting on the native query socket. Steam query packets are handed to the master server updater and its replies sent straight back;
+// only game packets are returned, back to back in one payload with an offset, address and port per packet.
+Dictionary SteamServer::pollQuerySocket() {
+	Dictionary packets;
+	if (!query_socket.isOpen()) {
+		return packets;
+	}
+	query_reply_batch.clear();
+	query_reply_list.clear();
+	PackedByteArray game_data;
+	PackedInt32Array offsets;
+	PackedInt32Array addresses;
+	PackedInt32Array ports;
+	int query_count = 0;
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	// With no player count to put in it, A2S_INFO is left to Steam
+	int players = server_info.players;
+	if (query_cache_enabled && players < 0 && query_players_from_auth_sessions) {
+		players = 0;
+		MutexLock lock(callback_mutex);
+		for (const KeyValue<uint64_t, AuthSession> &session : auth_sessions) {
+			if (session.value.state == AUTH_SESSION_STATE_APPROVED) {
+				players++;
+			}
+		}
+	}
+	for (int round = 0; round < QUERY_SOCKET_MAX_BATCHES; round++) {
+		int received = query_socket.receivePackets();
+		for (int i = 0; i < query_socket.getPacketCount(); i++) {
+			const SteamServerQuerySocket::Packet &packet = query_socket.getPacket(i);
+			const uint8_t *data = query_socket.getPacketData(i);
+			// Steam query packets all start with 0xFFFFFFFF
+			if (packet.size >= 4 && data[0] == 0xFF && data[1] == 0xFF && data[2] == 0xFF && data[3] == 0xFF) {
+				query_count++;
+				if (!takeQueryToken(packet.ip, now)) {
+					query_socket_dropped++;
+					continue;
+				}
+				if (query_cache_enabled && handleCachedQuery(data, packet.size, packet.ip, packet.port, players)) {
+					continue;
+				}
+				if (SteamGameServer() != NULL) {
+					SteamGameServer()->HandleIncomingPacket(data, packet.size, packet.ip, packet.port);
+				}
+				continue;
+			}
+			uint32 offset = game_data.size();
+			offsets.push_back(offset);
+			addresses.push_back((int32_t)packet.ip);
+			ports.push_back(packet.port);
+			game_data.resize(offset + packet.size);
+			memcpy(game_data.ptrw() + offset, data, packet.size);
+		}
+		if (received < query_socket.getBatchSize()) {
+			break;
+		}
+	}
+	int replies = query_socket.sendPackets(query_reply_batch.ptr(), query_reply_list.ptr(), query_reply_list.size());
+	if (SteamGameServer() != NULL) {
+		int reply_count = drainOutgoingPackets();
+		replies += query_socket.sendPackets(outgoing_packet_batch.ptr(), outgoing_packet_list.ptr(), reply_count);
+	}
+	// Forget buckets that have refilled completely so scans from many addresses do not grow the map forever
+	if (query_rate > 0.0 && now - query_bucket_prune_usec >= 1000000) {
+		query_bucket_prune_usec = now;
+		uint64_t idle_usec = (uint64_t)(query_burst / query_rate * 1000000.0);
+		LocalVector<uint32> idle;
+		for (const KeyValue<uint32, QueryTokenBucket> &bucket : query_buckets) {
+			if (now - bucket.value.last_usec >= idle_usec) {
+				idle.push_back(bucket.key);
+			}
+		}
+		for (uint32 i = 0; i < idle.size(); i++) {
+			query_buckets.erase(idle[i]);
+		}
+	}
+	query_socket_query_packets += query_count;
+	query_socket_game_packets += offsets.size();
+	query_socket_replies += replies;
+	packets["count"] = offsets.size();
+	packets["data"] = game_data;
+	packets["offsets"] = offsets;
+	packets["addresses"] = addresses;
+	packets["ports"] = ports;
+	packets["query_packets"] = query_count;
+	packets["replies_sent"] = replies;
+	return packets;
+}
+
+// Get how many packets the native query socket has handled since it was opened.
+Dictionary SteamServer::getQuerySocketStats() {
+	Dictionary stats;
+	stats["open"] = query_socket.isOpen();
+	stats["query_packets"] = query_socket_query_packets;
+	stats["game_packets"] = query_socket_game_packets;
+	stats["replies_sent"] = query_socket_replies;
+	stats["cached_replies"] = query_socket_cached_replies;
+	stats["challenges_sent"] = query_socket_challenges;
+	stats["dropped_packets"] = query_socket_dropped;
+	stats["truncated_packets"] = query_socket.getTruncatedCount();
+	stats["max_packet_size"] = query_socket.getPacketSize();
+	return stats;
+}
+
+// Set how the native query socket answers Steam queries. Keys, all optional: cache_replies to answer A2S_INFO and A2S_RULES from a cached reply instead of Steam,
+// players_from_auth_sessions to report approved auth sessions as the player count when setServerInfo has not set one,
+// rate in queries per second per source address (0 for no limit) and burst for how many queries an address may send at once.
+void SteamServer::setQueryPolicy(Dictionary policy) {
+	query_cache_enabled = policy.get("cache_replies", true);
+	query_players_from_auth_sessions = policy.get("players_from_auth_sessions", false);
+	double rate = policy.get("rate", 0.0);
+	double burst = policy.get("burst", 10.0);
+	query_rate = MAX(rate, 0.0);
+	query_burst = MAX(burst, 1.0);
+	query_buckets.clear();
+	query_info_dirty = true;
+	query_rules_dirty = true;
+}
+
+// Send a batch of game packets through the native query socket; packet i runs from offsets[i] to offsets[i + 1], or to the end of data for the last one. Returns how many were sent.
+int SteamServer::sendQuerySocketPackets(const PackedByteArray data, PackedInt32Array offsets, PackedInt32Array ips, PackedInt32Array ports) {
+	int packet_count = offsets.size();
+	if (!query_socket.isOpen() || packet_count == 0 || ips.size() != packet_count || ports.size() != packet_count) {
+		return 0;
+	}
+	int data_size = data.size();
+	outgoing_packet_list.clear();
+	for (int i = 0; i < packet_count; i++) {
+		int start = offsets[i];
+		int end = (i + 1 < packet_count) ? offsets[i + 1] : data_size;
+		if (start < 0 || end > data_size || end <= start) {
+			continue;
+		}
+		SteamServerQuerySocket::Packet packet;
+		packet.offset = start;
+		packet.size = end - start;
+		packet.ip = (uint32)ips[i];
+		packet.port = (uint16)ports[i];
+		outgoing_packet_list.push_back(packet);
+	}
+	return query_socket.sendPackets(data.ptr(), outgoing_packet_list.ptr(), outgoing_packet_list.size());
+}
+
 // AFTER calling HandleIncomingPacket for any packets that came in that frame, call this. This gets a packet that the master server updater needs to send out on UDP. Returns 0 if there are no more packets.
 Dictionary SteamServer::getNextOutgoingPacket() {
 	Dictionary packet;
@@ -603,10 +2307,12 @@ Dictionary SteamServer::getNextOutgoingPacket() {
 	}
 	PackedByteArray out;
 	int maxOut = 16 * 1024;
-	uint32 address;
-	uint16 port;
+	uint32 address = 0;
+	uint16 port = 0;
+	out.resize(maxOut);
 	// Retrieve the packet information
-	int length = SteamGameServer()->GetNextOutgoingPacket(&out, maxOut, &address, &port);
+	int length = SteamGameServer()->GetNextOutgoingPacket(out.ptrw(), maxOut, &address, &port);
+	out.resize(length);
 	// Place packet information in dictionary and return it
 	packet["length"] = length;
 	packet["out"] = out;
@@ -615,6 +2321,251 @@ Dictionary SteamServer::getNextOutgoingPacket() {
 	return packet;
 }
 
+// Copy every packet the master server updater wants to send into the outgoing batch buffer; returns how many there were.
+// The batch is a PackedByteArray so getAllOutgoingPackets can hand it to scripts without another copy.
+int SteamServer::drainOutgoingPackets() {
+	if (outgoing_packet_scratch.size() == 0) {
+		outgoing_packet_scratch.resize(OUTGOING_PACKET_SCRATCH_SIZE);
+	}
+	outgoing_packet_batch.clear();
+	outgoing_packet_list.clear();
+	uint32 address = 0;
+	uint16 port = 0;
+	int length = SteamGameServer()->GetNextOutgoingPacket(outgoing_packet_scratch.ptr(), OUTGOING_PACKET_SCRATCH_SIZE, &address, &port);
+	while (length > 0) {
+		SteamServerQuerySocket::Packet packet;
+		packet.offset = outgoing_packet_batch.size();
+		packet.size = length;
+		packet.ip = address;
+		packet.port = port;
+		outgoing_packet_list.push_back(packet);
+		outgoing_packet_batch.resize(packet.offset + length);
+		memcpy(outgoing_packet_batch.ptrw() + packet.offset, outgoing_packet_scratch.ptr(), length);
+		length = SteamGameServer()->GetNextOutgoingPacket(outgoing_packet_scratch.ptr(), OUTGOING_PACKET_SCRATCH_SIZE, &address, &port);
+	}
+	return outgoing_packet_list.size();
+}
+
+// Does a server info field need pushing to Steam: it changed, or has never been pushed since the server started
+bool SteamServer::serverInfoChanged(uint32 field, bool changed) {
+	return changed || !(server_info.pushed & field);
+}
+
+// Look up a licence result in the cache, asking Steam on a miss; only definite answers are cached. callback_mutex must be held
+int SteamServer::getLicenceResult(uint64_t steam_id, uint32 app_id) {
+	HashMap<uint32, int> *licences = licence_cache.getptr(steam_id);
+	if (licences != NULL) {
+		int *cached = licences->getptr(app_id);
+		if (cached != NULL) {
+			return *cached;
+		}
+	}
+	CSteamID userID = (uint64)steam_id;
+	EUserHasLicenseForAppResult result = SteamGameServer()->UserHasLicenseForApp(userID, (AppId_t)app_id);
+	if (result == k_EUserHasLicenseResultHasLicense || result == k_EUserHasLicenseResultDoesNotHaveLicense) {
+		if (licences == NULL) {
+			licences = &licence_cache.insert(steam_id, HashMap<uint32, int>())->value;
+		}
+		licences->insert(app_id, result);
+	}
+	return result;
+}
+
+// Take one query from a source address's token bucket; returns false if the address is over its rate
+bool SteamServer::takeQueryToken(uint32 ip, uint64_t now) {
+	if (query_rate <= 0.0) {
+		return true;
+	}
+	QueryTokenBucket *bucket = query_buckets.getptr(ip);
+	if (bucket == NULL) {
+		QueryTokenBucket new_bucket;
+		new_bucket.tokens = query_burst;
+		new_bucket.last_usec = now;
+		bucket = &query_buckets.insert(ip, new_bucket)->value;
+	}
+	else {
+		bucket->tokens = MIN(query_burst, bucket->tokens + (double)(now - bucket->last_usec) * query_rate / 1000000.0);
+		bucket->last_usec = now;
+	}
+	if (bucket->tokens < 1.0) {
+		return false;
+	}
+	bucket->tokens -= 1.0;
+	return true;
+}
+
+// Challenge number a source address has to echo back; derived from the address so nothing is stored per client
+uint32_t SteamServer::getQueryChallenge(uint32 ip) {
+	uint32_t challenge = hash_fmix32(hash_murmur3_one_32(ip, query_challenge_secret));
+	if (challenge == 0 || challenge == 0xFFFFFFFF) {
+		challenge = 1;
+	}
+	return challenge;
+}
+
+// Queue a reply to go out on the native query socket
+void SteamServer::addQueryReply(const uint8_t *data, uint32 size, uint32 ip, uint16 port) {
+	SteamServerQuerySocket::Packet packet;
+	packet.offset = query_reply_batch.size();
+	packet.size = size;
+	packet.ip = ip;
+	packet.port = port;
+	query_reply_list.push_back(packet);
+	query_reply_batch.resize(packet.offset + size);
+	memcpy(query_reply_batch.ptr() + packet.offset, data, size);
+}
+
+static void appendQueryByte(LocalVector<uint8_t> &reply, uint8_t value) {
+	reply.push_back(value);
+}
+
+static void appendQueryValue(LocalVector<uint8_t> &reply, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		reply.push_back((uint8_t)(value >> (8 * i)));
+	}
+}
+
+static void appendQueryString(LocalVector<uint8_t> &reply, const String &value) {
+	CharString utf8 = value.utf8();
+	uint32 offset = reply.size();
+	reply.resize(offset + utf8.length() + 1);
+	memcpy(reply.ptr() + offset, utf8.get_data(), utf8.length() + 1);
+}
+
+// Serialize an A2S_INFO reply from the server info shadow; the player count is patched in per reply
+void SteamServer::buildQueryInfoReply() {
+	query_info_reply.clear();
+	appendQueryValue(query_info_reply, 0xFFFFFFFF, 4);
+	appendQueryByte(query_info_reply, 'I');
+	appendQueryByte(query_info_reply, 17);
+	appendQueryString(query_info_reply, server_info.server_name);
+	appendQueryString(query_info_reply, server_info.map_name);
+	appendQueryString(query_info_reply, server_info.mod_dir);
+	appendQueryString(query_info_reply, server_info.game_description);
+	uint32 app_id = (SteamGameServerUtils() != NULL) ? SteamGameServerUtils()->GetAppID() : 0;
+	appendQueryValue(query_info_reply, app_id, 2);
+	query_info_player_offset = query_info_reply.size();
+	appendQueryByte(query_info_reply, 0);
+	appendQueryByte(query_info_reply, (uint8_t)CLAMP(server_info.max_players, 0, 255));
+	appendQueryByte(query_info_reply, (uint8_t)CLAMP(server_info.bot_players, 0, 255));
+	appendQueryByte(query_info_reply, server_info.dedicated ? 'd' : 'l');
+#if defined(_WIN32)
+	appendQueryByte(query_info_reply, 'w');
+#elif defined(__APPLE__)
+	appendQueryByte(query_info_reply, 'm');
+#else
+	appendQueryByte(query_info_reply, 'l');
+#endif
+	appendQueryByte(query_info_reply, server_info.password_protected ? 1 : 0);
+	appendQueryByte(query_info_reply, query_info_secure ? 1 : 0);
+	appendQueryString(query_info_reply, server_info.version);
+	// Extra data flags: game port, Steam ID, keywords and the full 64-bit game ID
+	appendQueryByte(query_info_reply, 0x80 | 0x10 | 0x20 | 0x01);
+	appendQueryValue(query_info_reply, server_info.game_port, 2);
+	appendQueryValue(query_info_reply, query_info_steam_id, 8);
+	appendQueryString(query_info_reply, server_info.game_tags);
+	appendQueryValue(query_info_reply, app_id, 8);
+	query_info_dirty = false;
+}
+
+// Serialize an A2S_RULES reply from the key / values; left empty if it would not fit in a single packet so Steam answers instead
+void SteamServer::buildQueryRulesReply() {
+	query_rules_reply.clear();
+	appendQueryValue(query_rules_reply, 0xFFFFFFFF, 4);
+	appendQueryByte(query_rules_reply, 'E');
+	appendQueryValue(query_rules_reply, server_info.key_values.size(), 2);
+	for (const KeyValue<String, String> &rule : server_info.key_values) {
+		appendQueryString(query_rules_reply, rule.key);
+		appendQueryString(query_rules_reply, rule.value);
+	}
+	if (query_rules_reply.size() > QUERY_REPLY_MAX_SIZE) {
+		query_rules_reply.clear();
+	}
+	query_rules_dirty = false;
+}
+
+// Answer A2S_INFO and A2S_RULES queries from the cached replies, sending a challenge first when the query does not carry the right one.
+// A2S_INFO is only answered when there is a player count, players >= 0. Returns false for anything else so it goes to Steam.
+bool SteamServer::handleCachedQuery(const uint8_t *data, uint32 size, uint32 ip, uint16 port, int players) {
+	static const char INFO_PAYLOAD[] = "Source Engine Query";
+	uint32 challenge_offset = 0;
+	if (players >= 0 && size >= 5 + sizeof(INFO_PAYLOAD) && data[4] == 'T' && memcmp(data + 5, INFO_PAYLOAD, sizeof(INFO_PAYLOAD)) == 0) {
+		challenge_offset = 5 + sizeof(INFO_PAYLOAD);
+	}
+	else if (size >= 9 && data[4] == 'V') {
+		if (query_rules_dirty) {
+			buildQueryRulesReply();
+		}
+		if (query_rules_reply.size() == 0) {
+			return false;
+		}
+		challenge_offset = 5;
+	}
+	else {
+		return false;
+	}
+	uint32_t expected = getQueryChallenge(ip);
+	uint32_t challenge = 0;
+	if (size >= challenge_offset + 4) {
+		challenge = data[challenge_offset] | (data[challenge_offset + 1] << 8) | (data[challenge_offset + 2] << 16) | ((uint32_t)data[challenge_offset + 3] << 24);
+	}
+	if (challenge != expected) {
+		uint8_t reply[9] = { 0xFF, 0xFF, 0xFF, 0xFF, 'A', (uint8_t)expected, (uint8_t)(expected >> 8), (uint8_t)(expected >> 16), (uint8_t)(expected >> 24) };
+		addQueryReply(reply, sizeof(reply), ip, port);
+		query_socket_challenges++;
+		return true;
+	}
+	if (data[4] == 'V') {
+		addQueryReply(query_rules_reply.ptr(), query_rules_reply.size(), ip, port);
+		query_socket_cached_replies++;
+		return true;
+	}
+	// The Steam ID and VAC status only settle after logging on, so check them without rebuilding every time
+	if (SteamGameServer() != NULL) {
+		uint64_t steam_id = SteamGameServer()->GetSteamID().ConvertToUint64();
+		bool is_secure = SteamGameServer()->BSecure();
+		if (steam_id != query_info_steam_id || is_secure != query_info_secure) {
+			query_info_steam_id = steam_id;
+			query_info_secure = is_secure;
+			query_info_dirty = true;
+		}
+	}
+	if (query_info_dirty) {
+		buildQueryInfoReply();
+	}
+	uint32 offset = query_reply_batch.size();
+	addQueryReply(query_info_reply.ptr(), query_info_reply.size(), ip, port);
+	query_reply_batch[offset + query_info_player_offset] = (uint8_t)CLAMP(players, 0, 255);
+	query_socket_cached_replies++;
+	return true;
+}
+
+// Drain every packet the master server updater wants to send, back to back in one payload with an offset, address and port per packet.
+Dictionary SteamServer::getAllOutgoingPackets() {
+	Dictionary packets;
+	if (SteamGameServer() == NULL) {
+		return packets;
+	}
+	int count = drainOutgoingPackets();
+	PackedInt32Array offsets;
+	PackedInt32Array addresses;
+	PackedInt32Array ports;
+	offsets.resize(count);
+	addresses.resize(count);
+	ports.resize(count);
+	for (int i = 0; i < count; i++) {
+		offsets.set(i, outgoing_packet_list[i].offset);
+		addresses.set(i, (int32_t)outgoing_packet_list[i].ip);
+		ports.set(i, outgoing_packet_list[i].port);
+	}
+	packets["count"] = offsets.size();
+	packets["data"] = outgoing_packet_batch;
+	packets["offsets"] = offsets;
+	packets["addresses"] = addresses;
+	packets["ports"] = ports;
+	return packets;
+}
+
 // Gets the public IP of the server according to Steam.
 Dictionary SteamServer::getPublicIP() {
 	Dictionary public_ip;
@@ -665,6 +2616,13 @@ bool SteamServer::clearUserAchievement(uint64_t steam_id, const String& name) {
 	if (SteamGameServerStats() == NULL) {
 		return false;
 	}
+	if (stats_buffer_enabled) {
+		MutexLock lock(callback_mutex);
+		StatsBuffer *buffer = stats_buffers.getptr(steam_id);
+		if (buffer != NULL) {
+			buffer->stats.erase(name);
+		}
+	}
 	CSteamID userID = (uint64)steam_id;
 	return SteamGameServerStats()->ClearUserAchievement(userID, name.utf8().get_data());
 }
@@ -679,6 +2637,13 @@ Dictionary SteamServer::getUserAchievement(uint64_t steam_id, const String& name
 	CSteamID user_id = (uint64)steam_id;
 	bool unlocked = false;
 	bool result = SteamGameServerStats()->GetUserAchievement(user_id, name.utf8().get_data(), &unlocked);
+	if (stats_buffer_enabled) {
+		MutexLock lock(callback_mutex);
+		const BufferedStat *buffered = findBufferedStat(steam_id, name);
+		if (buffered != NULL && buffered->type == BUFFERED_STAT_ACHIEVEMENT) {
+			unlocked = true;
+		}
+	}
 	// Populate the dictionary
 	achievement["result"] = result;
 	achievement["user"] = steam_id;
@@ -690,6 +2655,13 @@ Dictionary SteamServer::getUserAchievement(uint64_t steam_id, const String& name
 // Gets the current value of the a stat for the specified user.
 uint32_t SteamServer::getUserStatInt(uint64_t steam_id, const String& name) {
 	if (SteamGameServerStats() != NULL) {
+		if (stats_buffer_enabled) {
+			MutexLock lock(callback_mutex);
+			const BufferedStat *buffered = findBufferedStat(steam_id, name);
+			if (buffered != NULL && buffered->type == BUFFERED_STAT_INT) {
+				return buffered->int_value;
+			}
+		}
 		CSteamID userID = (uint64)steam_id;
 		int32 value = 0;
 		if (SteamGameServerStats()->GetUserStat(userID, name.utf8().get_data(), &value)) {
@@ -702,6 +2674,13 @@ uint32_t SteamServer::getUserStatInt(uint64_t steam_id, const String& name) {
 // Gets the current value of the a stat for the specified user.
 float SteamServer::getUserStatFloat(uint64_t steam_id, const String& name) {
 	if (SteamGameServerStats() != NULL) {
+		if (stats_buffer_enabled) {
+			MutexLock lock(callback_mutex);
+			const BufferedStat *buffered = findBufferedStat(steam_id, name);
+			if (buffered != NULL && buffered->type == BUFFERED_STAT_FLOAT) {
+				return buffered->float_value;
+			}
+		}
 		CSteamID userID = (uint64)steam_id;
 		float value = 0.0;
 		if (SteamGameServerStats()->GetUserStat(userID, name.utf8().get_data(), &value)) {
@@ -712,12 +2691,14 @@ float SteamServer::getUserStatFloat(uint64_t steam_id, const String& name) {
 }
 
 // Asynchronously downloads stats and achievements for the specified user from the server.
-void SteamServer::requestUserStats(uint64_t steam_id) {
+uint64_t SteamServer::requestUserStats(uint64_t steam_id) {
 	if (SteamGameServerStats() != NULL) {
 		CSteamID userID = (uint64)steam_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamGameServerStats()->RequestUserStats(userID);
-		callResultStatReceived.Set(api_call, this, &SteamServer::stats_received);
+		return trackCallResult(api_call, &SteamServer::stats_received, "requestUserStats");
 	}
+	return 0;
 }
 
 // Unlocks an achievement for the specified user.
@@ -725,6 +2706,11 @@ bool SteamServer::setUserAchievement(uint64_t steam_id, const String& name) {
 	if (SteamGameServerStats() == NULL) {
 		return false;
 	}
+	if (stats_buffer_enabled) {
+		BufferedStat stat;
+		stat.type = BUFFERED_STAT_ACHIEVEMENT;
+		return bufferStat(steam_id, name, stat);
+	}
 	CSteamID userID = (uint64)steam_id;
 	return SteamGameServerStats()->SetUserAchievement(userID, name.utf8().get_data());
 }
@@ -734,6 +2720,12 @@ bool SteamServer::setUserStatInt(uint64_t steam_id, const String& name, int32 st
 	if (SteamGameServerStats() == NULL) {
 		return false;
 	}
+	if (stats_buffer_enabled) {
+		BufferedStat buffered;
+		buffered.type = BUFFERED_STAT_INT;
+		buffered.int_value = stat;
+		return bufferStat(steam_id, name, buffered);
+	}
 	CSteamID userID = (uint64)steam_id;
 	return SteamGameServerStats()->SetUserStat(userID, name.utf8().get_data(), stat);
 }
@@ -743,18 +2735,94 @@ bool SteamServer::setUserStatFloat(uint64_t steam_id, const String& name, float
 	if (SteamGameServerStats() == NULL) {
 		return false;
 	}
+	if (stats_buffer_enabled) {
+		BufferedStat buffered;
+		buffered.type = BUFFERED_STAT_FLOAT;
+		buffered.float_value = stat;
+		return bufferStat(steam_id, name, buffered);
+	}
 	CSteamID userID = (uint64)steam_id;
 	return SteamGameServerStats()->SetUserStat(userID, name.utf8().get_data(), stat);
 }
 
 // Send the changed stats and achievements data to the server for permanent storage for the specified user.
+// With the stats buffer on, this only marks the player for storing at the next flush.
 void SteamServer::storeUserStats(uint64_t steam_id) {
 	if (SteamGameServerStats() != NULL) {
+		if (stats_buffer_enabled) {
+			MutexLock lock(callback_mutex);
+			getDirtyStatsBuffer(steam_id);
+			return;
+		}
 		CSteamID userID = (uint64)steam_id;
 		SteamGameServerStats()->StoreUserStats(userID);
 	}
 }
 
+// Buffer stat and achievement writes natively and store them for each player at most once per flush_interval seconds. Keys, all optional: flush_interval,
+// flush_on_disconnect to store a player's stats as soon as their last connection closes, retry_delay / retry_max_delay in seconds for backing off after failed stores,
+// and store_timeout in seconds before a store Steam has not answered counts as failed (0 to wait forever).
+void SteamServer::setStatsBufferPolicy(Dictionary policy) {
+	MutexLock lock(callback_mutex);
+	double flush_interval = policy.get("flush_interval", 30.0);
+	double retry_delay = policy.get("retry_delay", 5.0);
+	double retry_max_delay = policy.get("retry_max_delay", 300.0);
+	double store_timeout = policy.get("store_timeout", 30.0);
+	stats_flush_interval = (uint64_t)(MAX(flush_interval, 0.0) * 1000000.0);
+	stats_retry_delay = (uint64_t)(MAX(retry_delay, 0.0) * 1000000.0);
+	stats_retry_max_delay = (uint64_t)(MAX(retry_max_delay, retry_delay) * 1000000.0);
+	stats_store_timeout = (uint64_t)(MAX(store_timeout, 0.0) * 1000000.0);
+	stats_flush_on_disconnect = policy.get("flush_on_disconnect", true);
+	stats_buffer_enabled = true;
+}
+
+// Stop buffering stats; anything still buffered is pushed to Steam and stored first.
+void SteamServer::disableStatsBuffer() {
+	flushUserStats(0);
+	MutexLock lock(callback_mutex);
+	stats_buffer_enabled = false;
+}
+
+// Store a player's buffered stats now, or every player's if steam_id is 0, without waiting for the flush interval.
+void SteamServer::flushUserStats(uint64_t steam_id) {
+	if (steam_id == 0) {
+		flushStatsBuffers(true);
+		return;
+	}
+	MutexLock lock(callback_mutex);
+	StatsBuffer *buffer = stats_buffers.getptr(steam_id);
+	if (buffer != NULL && buffer->dirty && !buffer->storing) {
+		flushPlayerStats(steam_id, *buffer, OS::get_singleton()->get_ticks_usec());
+	}
+}
+
+// Get counters for the stats buffer along with how many players have writes waiting.
+Dictionary SteamServer::getStatsBufferStats() {
+	MutexLock lock(callback_mutex);
+	int pending_players = 0;
+	int backing_off = 0;
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	for (const KeyValue<uint64_t, StatsBuffer> &buffer : stats_buffers) {
+		if (buffer.value.dirty) {
+			pending_players++;
+		}
+		if (buffer.value.failures > 0 && now < buffer.value.retry_usec) {
+			backing_off++;
+		}
+	}
+	Dictionary stats;
+	stats["enabled"] = stats_buffer_enabled;
+	stats["writes"] = stats_buffer_writes;
+	stats["coalesced"] = stats_buffer_coalesced;
+	stats["stores"] = stats_buffer_stores;
+	stats["store_failures"] = stats_buffer_store_failures;
+	stats["store_timeouts"] = stats_buffer_store_timeouts;
+	stats["flush_failures"] = stats_buffer_flush_failures;
+	stats["pending_players"] = pending_players;
+	stats["backing_off"] = backing_off;
+	return stats;
+}
+
 // Updates an AVGRATE stat with new values for the specified user.
 bool SteamServer::updateUserAvgRateStat(uint64_t steam_id, const String& name, float this_session, double session_length) {
 	if (SteamGameServerStats() == NULL) {
@@ -1293,20 +3361,24 @@ bool SteamServer::loadItemDefinitions() {
 }
 
 // Request the list of "eligible" promo items that can be manually granted to the given user.
-void SteamServer::requestEligiblePromoItemDefinitionsIDs(uint64_t steam_id) {
+uint64_t SteamServer::requestEligiblePromoItemDefinitionsIDs(uint64_t steam_id) {
 	if (SteamInventory() != NULL) {
 		CSteamID user_id = (uint64)steam_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamInventory()->RequestEligiblePromoItemDefinitionsIDs(user_id);
-		callResultEligiblePromoItemDefIDs.Set(api_call, this, &SteamServer::inventory_eligible_promo_item);
+		return trackCallResult(api_call, &SteamServer::inventory_eligible_promo_item, "requestEligiblePromoItemDefinitionsIDs");
 	}
+	return 0;
 }
 
 // Request prices for all item definitions that can be purchased in the user's local currency. A SteamInventoryRequestPricesResult_t call result will be returned with the user's local currency code. After that, you can call GetNumItemsWithPrices and GetItemsWithPrices to get prices for all the known item definitions, or GetItemPrice for a specific item definition.
-void SteamServer::requestPrices() {
+uint64_t SteamServer::requestPrices() {
 	if (SteamInventory() != NULL) {
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamInventory()->RequestPrices();
-		callResultRequestPrices.Set(api_call, this, &SteamServer::inventory_request_prices_result);
+		return trackCallResult(api_call, &SteamServer::inventory_request_prices_result, "requestPrices");
 	}
+	return 0;
 }
 
 // Serialized result sets contain a short signature which can't be forged or replayed across different game sessions.
@@ -1329,7 +3401,7 @@ String SteamServer::serializeResult(int32 this_inventory_handle) {
 }
 
 // Starts the purchase process for the user, given a "shopping cart" of item definitions that the user would like to buy. The user will be prompted in the Steam Overlay to complete the purchase in their local currency, funding their Steam Wallet if necessary, etc.
-void SteamServer::startPurchase(const PackedInt64Array items, const PackedInt32Array quantity) {
+uint64_t SteamServer::startPurchase(const PackedInt64Array items, const PackedInt32Array quantity) {
 	if (SteamInventory() != NULL) {
 		uint32 total_items = items.size();
 		SteamItemDef_t *purchases = new SteamItemDef_t[total_items];
@@ -1337,10 +3409,13 @@ void SteamServer::startPurchase(const PackedInt64Array items, const PackedInt32A
 			purchases[i] = items[i];
 		}
 		uint32_t *these_quantities = (uint32*) quantity.ptr();
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamInventory()->StartPurchase(purchases, these_quantities, total_items);
-		callResultStartPurchase.Set(api_call, this, &SteamServer::inventory_start_purchase_result);
+		trackCallResult(api_call, &SteamServer::inventory_start_purchase_result, "startPurchase");
 		delete[] purchases;
+		return api_call;
 	}
+	return 0;
 }
 
 // Transfer items between stacks within a user's inventory.
@@ -1671,6 +3746,20 @@ Array SteamServer::receiveMessagesOnChannel(int channel, int max_messages) {
 	return messages;
 }
 
+// Same as receiveMessagesOnChannel, but returns SteamServerNetworkMessage objects that read the payload in place instead of copying it.
+Array SteamServer::receiveMessageObjectsOnChannel(int channel, int max_messages) {
+	Array messages;
+	if (SteamNetworkingMessages() != NULL && max_messages > 0) {
+		// Allocate the space for the messages
+		SteamNetworkingMessage_t** channel_messages = new SteamNetworkingMessage_t*[max_messages];
+		// Get the messages
+		int available_messages = SteamNetworkingMessages()->ReceiveMessagesOnChannel(channel, channel_messages, max_messages);
+		messages = wrapMessageObjects(channel_messages, available_messages);
+		delete [] channel_messages;
+	}
+	return messages;
+}
+
 // Sends a message to the specified host. If we don't already have a session with that user, a session is implicitly created. There might be some handshaking that needs to happen before we can actually begin sending message data.
 int SteamServer::sendMessageToUser(uint64_t remote_steam_id, const PackedByteArray data, int flags, int channel) {
 	if (SteamNetworkingMessages() == NULL) {
@@ -1739,6 +3828,9 @@ bool SteamServer::closeConnection(uint32 peer, int reason, const String& debug_m
 	if (SteamNetworkingSockets() == NULL) {
 		return false;
 	}
+	MutexLock lock(callback_mutex);
+	// No further status callbacks arrive for a connection we close ourselves
+	removeConnectionRecord(peer);
 	return SteamNetworkingSockets()->CloseConnection((HSteamNetConnection)peer, reason, debug_message.utf8().get_data(), linger);
 }
 
@@ -1747,6 +3839,17 @@ bool SteamServer::closeListenSocket(uint32 socket) {
 	if (SteamNetworkingSockets() == NULL) {
 		return false;
 	}
+	MutexLock lock(callback_mutex);
+	// Connections accepted on this socket are closed with it, without status callbacks
+	LocalVector<uint32> closed_connections;
+	for (const KeyValue<uint32, ConnectionRecord> &connection : connection_records) {
+		if (connection.value.listen_socket == socket) {
+			closed_connections.push_back(connection.key);
+		}
+	}
+	for (uint32 i = 0; i < closed_connections.size(); i++) {
+		removeConnectionRecord(closed_connections[i]);
+	}
 	return SteamNetworkingSockets()->CloseListenSocket((HSteamListenSocket)socket);
 }
 
@@ -1782,19 +3885,379 @@ Dictionary SteamServer::sendMessageToConnection(uint32 connection_handle, const
 }
 
 // Send one or more messages without copying the message payload. This is the most efficient way to send messages. To use this function, you must first allocate a message object using ISteamNetworkingUtils::AllocateMessage. (Do not declare one on the stack or allocate your own.)
+// Only one message is built from data, so messages is treated as one; use sendMessagesBatch to send several.
 void SteamServer::sendMessages(int messages, const PackedByteArray data, uint32 connection_handle, int flags) {
-	if (SteamNetworkingSockets() != NULL) {
-		SteamNetworkingMessage_t *networkMessage;
-		networkMessage = SteamNetworkingUtils()->AllocateMessage(0);
-		networkMessage->m_pData = (void *)data.ptr();
-		networkMessage->m_cbSize = data.size();
+	if (SteamNetworkingSockets() != NULL && SteamNetworkingUtils() != NULL && messages > 0) {
+		SteamNetworkingMessage_t *networkMessage = allocateZeroCopyMessage(data);
 		networkMessage->m_conn = (HSteamNetConnection)connection_handle;
 		networkMessage->m_nFlags = flags;
 		int64 result;
-		SteamNetworkingSockets()->SendMessages(messages, &networkMessage, &result);
-		// Release the message
-		networkMessage->Release();
+		// Steam owns the message from here on and frees it, and our reference on data, once it is sent
+		SteamNetworkingSockets()->SendMessages(1, &networkMessage, &result);
+	}
+}
+
+// Send a message without copying its payload. The message keeps a reference on data's storage until Steam has sent it, so data can be changed or freed right after this returns.
+// Best suited to large payloads such as map chunks; small messages are cheaper to send with sendMessageToConnection.
+Dictionary SteamServer::sendMessageZeroCopy(uint32 connection_handle, const PackedByteArray data, int flags, int lane) {
+	Dictionary message_response;
+	if (SteamNetworkingSockets() != NULL && SteamNetworkingUtils() != NULL) {
+		SteamNetworkingMessage_t *message = allocateZeroCopyMessage(data);
+		message->m_conn = (HSteamNetConnection)connection_handle;
+		message->m_nFlags = flags;
+		message->m_idxLane = (uint16)lane;
+		int64 number;
+		SteamNetworkingSockets()->SendMessages(1, &message, &number);
+		// Negative values are a failed EResult, anything else is the message number
+		if (number < 0) {
+			message_response["result"] = (int)-number;
+			message_response["message_number"] = 0;
+		}
+		else {
+			message_response["result"] = k_EResultOK;
+			message_response["message_number"] = (uint64_t)number;
+		}
+	}
+	return message_response;
+}
+
+// Queue a message to be sent on the next flushQueuedMessages, instead of crossing into Steam once per message.
+// With packing enabled, small unreliable messages to the same connection are packed together if setConnectionPacking has turned packing on for it.
+bool SteamServer::queueMessage(uint32 connection_handle, const PackedByteArray data, int flags, int lane) {
+	if (SteamNetworkingSockets() == NULL) {
+		return false;
+	}
+	QueuedMessage queued_message;
+	queued_message.connection = connection_handle;
+	queued_message.flags = flags;
+	queued_message.lane = (uint16)lane;
+	queued_message.offset = outbound_payload.size();
+	queued_message.size = data.size();
+	outbound_payload.resize(queued_message.offset + queued_message.size);
+	if (queued_message.size > 0) {
+		memcpy(outbound_payload.ptr() + queued_message.offset, data.ptr(), queued_message.size);
+	}
+	outbound_queue.push_back(queued_message);
+	return true;
+}
+
+// Send everything queued with queueMessage in a single SendMessages call. Returns the number of messages handed to Steam, which is lower than the number queued when packing combined some of them.
+int SteamServer::flushQueuedMessages() {
+	int queued_count = outbound_queue.size();
+	if (SteamNetworkingSockets() == NULL || SteamNetworkingUtils() == NULL || queued_count == 0) {
+		return 0;
+	}
+	SteamNetworkingMessage_t** outbound_messages = new SteamNetworkingMessage_t*[queued_count];
+	int outbound_count = 0;
+	// The packed message still open for each connection, as an index into outbound_messages
+	HashMap<uint32, int> open_packed_messages;
+	MutexLock lock(callback_mutex);
+	for (int i = 0; i < queued_count; i++) {
+		const QueuedMessage &queued_message = outbound_queue[i];
+		const uint8_t *source_data = outbound_payload.ptr() + queued_message.offset;
+		// Only a connection that has negotiated packing knows to look for the envelope
+		bool enveloped = !(queued_message.flags & k_nSteamNetworkingSend_Reliable) && isPackingConnection(queued_message.connection);
+		bool pack = enveloped && outbound_packing && queued_message.size <= 0xFFFF && PACKED_MESSAGE_HEADER_SIZE + 2 + queued_message.size <= outbound_packed_size;
+		if (!pack) {
+			// Unreliable messages that are not packed still carry the envelope so the receiver can tell them apart
+			int header_size = enveloped ? PACKED_MESSAGE_HEADER_SIZE : 0;
+			SteamNetworkingMessage_t *message = SteamNetworkingUtils()->AllocateMessage(header_size + queued_message.size);
+			if (enveloped) {
+				((uint8_t *)message->m_pData)[0] = PACKED_MESSAGE_SINGLE;
+			}
+			if (queued_message.size > 0) {
+				memcpy((uint8_t *)message->m_pData + header_size, source_data, queued_message.size);
+			}
+			message->m_conn = (HSteamNetConnection)queued_message.connection;
+			message->m_nFlags = queued_message.flags;
+			message->m_idxLane = queued_message.lane;
+			outbound_messages[outbound_count++] = message;
+			continue;
+		}
+		// Start a new packed message if there is none open for this connection, or it does not match or has no room
+		SteamNetworkingMessage_t *packed_message = NULL;
+		HashMap<uint32, int>::Iterator open_message = open_packed_messages.find(queued_message.connection);
+		if (open_message) {
+			packed_message = outbound_messages[open_message->value];
+			if (packed_message->m_nFlags != queued_message.flags || packed_message->m_idxLane != queued_message.lane || packed_message->m_cbSize + 2 + queued_message.size > outbound_packed_size) {
+				packed_message = NULL;
+			}
+		}
+		if (packed_message == NULL) {
+			packed_message = SteamNetworkingUtils()->AllocateMessage(outbound_packed_size);
+			((uint8_t *)packed_message->m_pData)[0] = PACKED_MESSAGE_PACKED;
+			packed_message->m_cbSize = PACKED_MESSAGE_HEADER_SIZE;
+			packed_message->m_conn = (HSteamNetConnection)queued_message.connection;
+			packed_message->m_nFlags = queued_message.flags;
+			packed_message->m_idxLane = queued_message.lane;
+			open_packed_messages[queued_message.connection] = outbound_count;
+			outbound_messages[outbound_count++] = packed_message;
+		}
+		// Each frame is a little-endian u16 length followed by the message
+		uint8_t *frame = (uint8_t *)packed_message->m_pData + packed_message->m_cbSize;
+		frame[0] = queued_message.size & 0xFF;
+		frame[1] = (queued_message.size >> 8) & 0xFF;
+		if (queued_message.size > 0) {
+			memcpy(frame + 2, source_data, queued_message.size);
+		}
+		packed_message->m_cbSize += 2 + queued_message.size;
+	}
+	// Steam takes ownership of every message, whether or not it could be sent
+	SteamNetworkingSockets()->SendMessages(outbound_count, outbound_messages, NULL);
+	delete [] outbound_messages;
+	outbound_queue.clear();
+	outbound_payload.clear();
+	return outbound_count;
+}
+
+// Get the number of messages waiting in the outbound queue.
+int SteamServer::getQueuedMessageCount() {
+	return outbound_queue.size();
+}
+
+// Choose when the outbound queue is flushed automatically: never, or at the start of every process or physics frame. Returns false if there is no SceneTree to hook into.
+bool SteamServer::setOutboundFlushMode(OutboundFlushMode mode) {
+	SceneTree *scene_tree = SceneTree::get_singleton();
+	if (scene_tree == NULL) {
+		return false;
+	}
+	Callable flush_callable = callable_mp(this, &SteamServer::flush_queued_messages_on_frame);
+	if (scene_tree->is_connected("process_frame", flush_callable)) {
+		scene_tree->disconnect("process_frame", flush_callable);
+	}
+	if (scene_tree->is_connected("physics_frame", flush_callable)) {
+		scene_tree->disconnect("physics_frame", flush_callable);
+	}
+	if (mode == OUTBOUND_FLUSH_PROCESS_FRAME) {
+		scene_tree->connect("process_frame", flush_callable);
+	}
+	else if (mode == OUTBOUND_FLUSH_PHYSICS_FRAME) {
+		scene_tree->connect("physics_frame", flush_callable);
+	}
+	return true;
+}
+
+// Turn packing of small unreliable messages on or off for connections that have packing negotiated. Packed messages are at most max_packed_size bytes, including their envelope byte.
+void SteamServer::setOutboundPacking(bool enabled, int max_packed_size) {
+	outbound_packing = enabled;
+	outbound_packed_size = CLAMP(max_packed_size, PACKED_MESSAGE_HEADER_SIZE + 3, k_cbMaxSteamNetworkingSocketsMessageSizeSend);
+}
+
+// Get the number of connections in the connection registry.
+int SteamServer::getConnectionCount() {
+	MutexLock lock(callback_mutex);
+	return connection_records.size();
+}
+
+// Get the newest connection handle for a remote Steam ID from the connection registry, or 0 if there is none.
+uint32 SteamServer::getConnectionBySteamID(uint64_t remote_steam_id) {
+	MutexLock lock(callback_mutex);
+	HashMap<uint64_t, LocalVector<uint32>>::Iterator handles = connection_handles_by_steam_id.find(remote_steam_id);
+	if (!handles) {
+		return 0;
+	}
+	return handles->value[handles->value.size() - 1];
+}
+
+// Get everything the connection registry holds about one connection. Empty if the connection is not registered.
+Dictionary SteamServer::getConnectionRecord(uint32 connection_handle) {
+	MutexLock lock(callback_mutex);
+	Dictionary record;
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(connection_handle);
+	if (connection) {
+		record["connection"] = connection_handle;
+		record["identity"] = connection->value.steam_id;
+		record["state"] = connection->value.state;
+		record["listen_socket"] = connection->value.listen_socket;
+		record["poll_group"] = connection->value.poll_group;
+		record["user_data"] = (uint64_t)connection->value.user_data;
+		record["remote_address"] = getStringFromIP(connection->value.remote_ip);
+		record["remote_port"] = connection->value.remote_port;
+		record["connect_time"] = (uint64_t)connection->value.connect_time;
+		record["packing"] = connection->value.packing;
+	}
+	return record;
+}
+
+// Get the last known state of a connection from the connection registry.
+SteamServer::NetworkingConnectionState SteamServer::getConnectionState(uint32 connection_handle) {
+	MutexLock lock(callback_mutex);
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(connection_handle);
+	if (!connection) {
+		return CONNECTION_STATE_NONE;
+	}
+	return NetworkingConnectionState(connection->value.state);
+}
+
+// Get the remote Steam ID of a connection from the connection registry, or 0 if it is not registered.
+uint64_t SteamServer::getConnectionSteamID(uint32 connection_handle) {
+	MutexLock lock(callback_mutex);
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(connection_handle);
+	if (!connection) {
+		return 0;
+	}
+	return connection->value.steam_id;
+}
+
+// Get every connection in the connection registry as parallel packed arrays.
+Dictionary SteamServer::getActiveConnections() {
+	MutexLock lock(callback_mutex);
+	Dictionary active_connections;
+	int connection_count = connection_records.size();
+	PackedInt32Array handles;
+	handles.resize(connection_count);
+	PackedInt64Array steam_ids;
+	steam_ids.resize(connection_count);
+	PackedInt32Array states;
+	states.resize(connection_count);
+	PackedInt32Array listen_sockets;
+	listen_sockets.resize(connection_count);
+	PackedInt32Array poll_groups;
+	poll_groups.resize(connection_count);
+	PackedInt64Array user_data;
+	user_data.resize(connection_count);
+	PackedInt64Array connect_times;
+	connect_times.resize(connection_count);
+	int i = 0;
+	for (const KeyValue<uint32, ConnectionRecord> &connection : connection_records) {
+		handles.set(i, connection.key);
+		steam_ids.set(i, connection.value.steam_id);
+		states.set(i, connection.value.state);
+		listen_sockets.set(i, connection.value.listen_socket);
+		poll_groups.set(i, connection.value.poll_group);
+		user_data.set(i, connection.value.user_data);
+		connect_times.set(i, connection.value.connect_time);
+		i++;
+	}
+	active_connections["count"] = connection_count;
+	active_connections["connections"] = handles;
+	active_connections["identities"] = steam_ids;
+	active_connections["states"] = states;
+	active_connections["listen_sockets"] = listen_sockets;
+	active_connections["poll_groups"] = poll_groups;
+	active_connections["user_data"] = user_data;
+	active_connections["connect_times"] = connect_times;
+	return active_connections;
+}
+
+// Handle incoming connections natively instead of waiting for a script to call acceptConnection. Each new connection is accepted or closed inside the status callback, and an admission_summary signal follows once run_callbacks is done.
+// Keys, all optional: max_connections, max_attempts_per_ip, max_attempts_per_steam_id (0 for no limit), rate_window in seconds (0 to count attempts for the whole session), poll_group to put accepted connections in and end_reason for rejected ones.
+void SteamServer::setAdmissionPolicy(Dictionary policy) {
+	MutexLock lock(callback_mutex);
+	admission_max_connections = policy.get("max_connections", 0);
+	admission_max_attempts_per_ip = policy.get("max_attempts_per_ip", 0);
+	admission_max_attempts_per_steam_id = policy.get("max_attempts_per_steam_id", 0);
+	double rate_window = policy.get("rate_window", 10.0);
+	admission_rate_window = (SteamNetworkingMicroseconds)(MAX(rate_window, 0.0) * 1000000.0);
+	admission_poll_group = (uint32)(int64_t)policy.get("poll_group", k_HSteamNetPollGroup_Invalid);
+	admission_end_reason = policy.get("end_reason", k_ESteamNetConnectionEnd_App_Generic);
+	admission_attempts.clear();
+	admission_enabled = true;
+}
+
+// Stop handling incoming connections natively; scripts must accept them again.
+void SteamServer::disableAdmissionPolicy() {
+	MutexLock lock(callback_mutex);
+	admission_enabled = false;
+	admission_attempts.clear();
+}
+
+// Add a Steam ID to the admission ban list; its connections are closed as soon as they arrive.
+void SteamServer::addAdmissionBan(uint64_t steam_id) {
+	MutexLock lock(callback_mutex);
+	admission_bans.insert(steam_id);
+}
+
+// Remove a Steam ID from the admission ban list.
+void SteamServer::removeAdmissionBan(uint64_t steam_id) {
+	MutexLock lock(callback_mutex);
+	admission_bans.erase(steam_id);
+}
+
+// Empty the admission ban list.
+void SteamServer::clearAdmissionBans() {
+	MutexLock lock(callback_mutex);
+	admission_bans.clear();
+}
+
+// Send a batch of messages, each to its own connection, in a single SendMessages call. Payloads are slices of data given by offsets and sizes.
+// flags and lanes may hold one value per message, a single value for every message, or be empty for unreliable sends on lane 0.
+// Returns one entry per message: the message number if it was queued, or the negated EResult if it failed.
+PackedInt64Array SteamServer::sendMessagesBatch(PackedInt32Array connections, const PackedByteArray data, PackedInt32Array offsets, PackedInt32Array sizes, PackedInt32Array flags, PackedInt32Array lanes) {
+	PackedInt64Array results;
+	int message_count = connections.size();
+	if (SteamNetworkingSockets() == NULL || SteamNetworkingUtils() == NULL || message_count == 0) {
+		return results;
+	}
+	if (offsets.size() != message_count || sizes.size() != message_count) {
+		return results;
+	}
+	results.resize(message_count);
+	int64_t *results_data = results.ptrw();
+	const uint8_t *source_data = data.ptr();
+	int data_size = data.size();
+	// Allocate every valid message up front so they go to Steam together
+	SteamNetworkingMessage_t** batch_messages = new SteamNetworkingMessage_t*[message_count];
+	int *batch_index = new int[message_count];
+	int batch_count = 0;
+	for (int i = 0; i < message_count; i++) {
+		int offset = offsets[i];
+		int size = sizes[i];
+		if (offset < 0 || size < 0 || offset > data_size - size) {
+			results_data[i] = -k_EResultInvalidParam;
+			continue;
+		}
+		SteamNetworkingMessage_t *message = SteamNetworkingUtils()->AllocateMessage(size);
+		if (size > 0) {
+			memcpy(message->m_pData, source_data + offset, size);
+		}
+		message->m_conn = (HSteamNetConnection)connections[i];
+		if (flags.size() > 0) {
+			message->m_nFlags = flags[flags.size() == message_count ? i : 0];
+		}
+		if (lanes.size() > 0) {
+			message->m_idxLane = (uint16)lanes[lanes.size() == message_count ? i : 0];
+		}
+		batch_messages[batch_count] = message;
+		batch_index[batch_count] = i;
+		batch_count++;
+	}
+	if (batch_count > 0) {
+		int64 *batch_results = new int64[batch_count];
+		// Steam takes ownership of every message, whether or not it could be sent
+		SteamNetworkingSockets()->SendMessages(batch_count, batch_messages, batch_results);
+		for (int i = 0; i < batch_count; i++) {
+			results_data[batch_index[i]] = batch_results[i];
+		}
+		delete [] batch_results;
+	}
+	delete [] batch_messages;
+	delete [] batch_index;
+	return results;
+}
+
+// Send the same payload to many connections without copying it per recipient. Every message points at one shared, refcounted copy of the payload, which is freed once Steam is done with the last message.
+// Returns one entry per connection: the message number if it was queued, or the negated EResult if it failed.
+PackedInt64Array SteamServer::broadcastMessage(PackedInt32Array connections, const PackedByteArray payload, int flags) {
+	PackedInt64Array results;
+	int message_count = connections.size();
+	if (SteamNetworkingSockets() == NULL || SteamNetworkingUtils() == NULL || message_count == 0) {
+		return results;
+	}
+	results.resize(message_count);
+	// One holder for every recipient; each message holds one reference and drops it when Steam frees it
+	SharedPayload *shared_payload = NULL;
+	SteamNetworkingMessage_t** broadcast_messages = new SteamNetworkingMessage_t*[message_count];
+	for (int i = 0; i < message_count; i++) {
+		SteamNetworkingMessage_t *message = allocateZeroCopyMessage(payload, &shared_payload);
+		message->m_conn = (HSteamNetConnection)connections[i];
+		message->m_nFlags = flags;
+		broadcast_messages[i] = message;
 	}
+	// Steam takes ownership of every message, whether or not it could be sent
+	SteamNetworkingSockets()->SendMessages(message_count, broadcast_messages, (int64 *)results.ptrw());
+	delete [] broadcast_messages;
+	return results;
 }
 
 // Flush any messages waiting on the Nagle timer and send them at the next transmission opportunity (often that means right now).
@@ -1845,6 +4308,20 @@ Array SteamServer::receiveMessagesOnConnection(uint32 connection_handle, int max
 	return messages;
 }
 
+// Same as receiveMessagesOnConnection, but returns SteamServerNetworkMessage objects that read the payload in place instead of copying it.
+Array SteamServer::receiveMessageObjectsOnConnection(uint32 connection_handle, int max_messages) {
+	Array messages;
+	if (SteamNetworkingSockets() != NULL && max_messages > 0) {
+		// Allocate the space for the messages
+		SteamNetworkingMessage_t** connection_messages = new SteamNetworkingMessage_t*[max_messages];
+		// Get the messages
+		int available_messages = SteamNetworkingSockets()->ReceiveMessagesOnConnection((HSteamNetConnection)connection_handle, connection_messages, max_messages);
+		messages = wrapMessageObjects(connection_messages, available_messages);
+		delete [] connection_messages;
+	}
+	return messages;
+}
+
 // Create a new poll group.
 uint32 SteamServer::createPollGroup() {
 	if (SteamNetworkingSockets() == NULL) {
@@ -1866,7 +4343,15 @@ bool SteamServer::setConnectionPollGroup(uint32 connection_handle, uint32 poll_g
 	if (SteamNetworkingSockets() == NULL) {
 		return false;
 	}
-	return SteamNetworkingSockets()->SetConnectionPollGroup((HSteamNetConnection)connection_handle, (HSteamNetPollGroup)poll_group);
+	MutexLock lock(callback_mutex);
+	if (!SteamNetworkingSockets()->SetConnectionPollGroup((HSteamNetConnection)connection_handle, (HSteamNetPollGroup)poll_group)) {
+		return false;
+	}
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(connection_handle);
+	if (connection) {
+		connection->value.poll_group = poll_group;
+	}
+	return true;
 }
 
 // Same as ReceiveMessagesOnConnection, but will return the next messages available on any connection in the poll group. Examine SteamNetworkingMessage_t::m_conn to know which connection. (SteamNetworkingMessage_t::m_nConnUserData might also be useful.)
@@ -1909,6 +4394,36 @@ Array SteamServer::receiveMessagesOnPollGroup(uint32 poll_group, int max_message
 	return messages;
 }
 
+// Same as receiveMessagesOnPollGroup, but returns SteamServerNetworkMessage objects that read the payload in place instead of copying it.
+Array SteamServer::receiveMessageObjectsOnPollGroup(uint32 poll_group, int max_messages) {
+	Array messages;
+	if (SteamNetworkingSockets() != NULL && max_messages > 0) {
+		// Allocate the space for the messages
+		SteamNetworkingMessage_t** poll_messages = new SteamNetworkingMessage_t*[max_messages];
+		// Get the messages
+		int available_messages = SteamNetworkingSockets()->ReceiveMessagesOnPollGroup((HSteamNetPollGroup)poll_group, poll_messages, max_messages);
+		messages = wrapMessageObjects(poll_messages, available_messages);
+		delete [] poll_messages;
+	}
+	return messages;
+}
+
+// Same as receiveMessagesOnPollGroup, but returns every message in one struct-of-arrays dictionary instead of one dictionary per message.
+// Payloads are concatenated into a single byte array; use offsets and sizes to slice out each message.
+Dictionary SteamServer::receiveMessagesOnPollGroupBatch(uint32 poll_group, int max_messages, bool unpack) {
+	Dictionary batch;
+	if (SteamNetworkingSockets() != NULL && max_messages > 0) {
+		// Allocate the space for the messages
+		SteamNetworkingMessage_t** poll_messages = new SteamNetworkingMessage_t*[max_messages];
+		// Get the messages
+		int available_messages = SteamNetworkingSockets()->ReceiveMessagesOnPollGroup((HSteamNetPollGroup)poll_group, poll_messages, max_messages);
+		// Copy them into the batch; this also releases them
+		batch = packMessageBatch(poll_messages, available_messages, unpack);
+		delete [] poll_messages;
+	}
+	return batch;
+}
+
 // Returns basic information about the high-level state of the connection. Returns false if the connection handle is invalid.
 Dictionary SteamServer::getConnectionInfo(uint32 connection_handle) {
 	Dictionary connection_info;
@@ -1953,6 +4468,33 @@ uint64_t SteamServer::getConnectionUserData(uint32 peer) {
 	return SteamNetworkingSockets()->GetConnectionUserData((HSteamNetConnection)peer);
 }
 
+// Set connection user data. The data is returned in received messages and connection status callbacks, and kept in the connection registry.
+bool SteamServer::setConnectionUserData(uint32 peer, uint64_t user_data) {
+	if (SteamNetworkingSockets() == NULL) {
+		return false;
+	}
+	MutexLock lock(callback_mutex);
+	if (!SteamNetworkingSockets()->SetConnectionUserData((HSteamNetConnection)peer, (int64)user_data)) {
+		return false;
+	}
+	HashMap<uint32, ConnectionRecord>::Iterator connection = connection_records.find(peer);
+	if (connection) {
+		connection->value.user_data = (int64)user_data;
+	}
+	return true;
+}
+
+// Mark a connection as having negotiated packing with its peer, so its unreliable messages carry an envelope byte both ways. Returns false if the connection is not registered.
+bool SteamServer::setConnectionPacking(uint32 connection_handle, bool enabled) {
+	MutexLock lock(callback_mutex);
+	ConnectionRecord *record = connection_records.getptr(connection_handle);
+	if (record == NULL) {
+		return false;
+	}
+	record->packing = enabled;
+	return true;
+}
+
 // Set a name for the connection, used mostly for debugging
 void SteamServer::setConnectionName(uint32 peer, const String& name) {
 	if (SteamNetworkingSockets() != NULL) {
@@ -2134,6 +4676,287 @@ Dictionary SteamServer::getConnectionRealTimeStatus(uint32 connection, int lanes
 	return real_time_status;
 }
 
+// Get the real-time status of every connection in the connection registry in one call, as parallel packed arrays.
+// If lanes is above zero, the status of that many lanes per connection is added too, flattened so that lane j of connection i is at index i * lanes + j.
+Dictionary SteamServer::getAllConnectionsRealTimeStatus(int lanes) {
+	MutexLock lock(callback_mutex);
+	Dictionary all_status;
+	if (SteamNetworkingSockets() == NULL) {
+		return all_status;
+	}
+	if (lanes < 0) {
+		lanes = 0;
+	}
+	int connection_count = connection_records.size();
+	PackedInt32Array connections;
+	connections.resize(connection_count);
+	PackedInt32Array states;
+	states.resize(connection_count);
+	PackedInt32Array pings;
+	pings.resize(connection_count);
+	PackedFloat32Array local_quality;
+	local_quality.resize(connection_count);
+	PackedFloat32Array remote_quality;
+	remote_quality.resize(connection_count);
+	PackedFloat32Array packets_out_per_second;
+	packets_out_per_second.resize(connection_count);
+	PackedFloat32Array bytes_out_per_second;
+	bytes_out_per_second.resize(connection_count);
+	PackedFloat32Array packets_in_per_second;
+	packets_in_per_second.resize(connection_count);
+	PackedFloat32Array bytes_in_per_second;
+	bytes_in_per_second.resize(connection_count);
+	PackedInt32Array send_rate;
+	send_rate.resize(connection_count);
+	PackedInt32Array pending_unreliable;
+	pending_unreliable.resize(connection_count);
+	PackedInt32Array pending_reliable;
+	pending_reliable.resize(connection_count);
+	PackedInt32Array sent_unacknowledged_reliable;
+	sent_unacknowledged_reliable.resize(connection_count);
+	PackedInt64Array queue_time;
+	queue_time.resize(connection_count);
+	PackedInt32Array lane_pending_unreliable;
+	lane_pending_unreliable.resize(connection_count * lanes);
+	PackedInt32Array lane_pending_reliable;
+	lane_pending_reliable.resize(connection_count * lanes);
+	PackedInt32Array lane_sent_unacknowledged_reliable;
+	lane_sent_unacknowledged_reliable.resize(connection_count * lanes);
+	PackedInt64Array lane_queue_time;
+	lane_queue_time.resize(connection_count * lanes);
+	// Reuse one lanes buffer for every connection
+	if (status_lanes.size() < (uint32)lanes) {
+		status_lanes.resize(lanes);
+	}
+	int count = 0;
+	for (const KeyValue<uint32, ConnectionRecord> &connection : connection_records) {
+		SteamNetConnectionRealTimeStatus_t this_status;
+		int connection_lanes = lanes;
+		EResult result = SteamNetworkingSockets()->GetConnectionRealTimeStatus((HSteamNetConnection)connection.key, &this_status, connection_lanes, connection_lanes > 0 ? status_lanes.ptr() : NULL);
+		// Asking for more lanes than the connection has configured fails, so fall back to the connection status alone
+		if (result == k_EResultInvalidParam && connection_lanes > 0) {
+			connection_lanes = 0;
+			result = SteamNetworkingSockets()->GetConnectionRealTimeStatus((HSteamNetConnection)connection.key, &this_status, 0, NULL);
+		}
+		if (result != k_EResultOK) {
+			continue;
+		}
+		connections.set(count, connection.key);
+		states.set(count, this_status.m_eState);
+		pings.set(count, this_status.m_nPing);
+		local_quality.set(count, this_status.m_flConnectionQualityLocal);
+		remote_quality.set(count, this_status.m_flConnectionQualityRemote);
+		packets_out_per_second.set(count, this_status.m_flOutPacketsPerSec);
+		bytes_out_per_second.set(count, this_status.m_flOutBytesPerSec);
+		packets_in_per_second.set(count, this_status.m_flInPacketsPerSec);
+		bytes_in_per_second.set(count, this_status.m_flInBytesPerSec);
+		send_rate.set(count, this_status.m_nSendRateBytesPerSecond);
+		pending_unreliable.set(count, this_status.m_cbPendingUnreliable);
+		pending_reliable.set(count, this_status.m_cbPendingReliable);
+		sent_unacknowledged_reliable.set(count, this_status.m_cbSentUnackedReliable);
+		queue_time.set(count, this_status.m_usecQueueTime);
+		for (int i = 0; i < lanes; i++) {
+			int lane_index = count * lanes + i;
+			if (i < connection_lanes) {
+				lane_pending_unreliable.set(lane_index, status_lanes[i].m_cbPendingUnreliable);
+				lane_pending_reliable.set(lane_index, status_lanes[i].m_cbPendingReliable);
+				lane_sent_unacknowledged_reliable.set(lane_index, status_lanes[i].m_cbSentUnackedReliable);
+				lane_queue_time.set(lane_index, status_lanes[i].m_usecQueueTime);
+			}
+			else {
+				lane_pending_unreliable.set(lane_index, 0);
+				lane_pending_reliable.set(lane_index, 0);
+				lane_sent_unacknowledged_reliable.set(lane_index, 0);
+				lane_queue_time.set(lane_index, 0);
+			}
+		}
+		count++;
+	}
+	// Trim off connections Steam no longer knew about
+	if (count < connection_count) {
+		connections.resize(count);
+		states.resize(count);
+		pings.resize(count);
+		local_quality.resize(count);
+		remote_quality.resize(count);
+		packets_out_per_second.resize(count);
+		bytes_out_per_second.resize(count);
+		packets_in_per_second.resize(count);
+		bytes_in_per_second.resize(count);
+		send_rate.resize(count);
+		pending_unreliable.resize(count);
+		pending_reliable.resize(count);
+		sent_unacknowledged_reliable.resize(count);
+		queue_time.resize(count);
+		lane_pending_unreliable.resize(count * lanes);
+		lane_pending_reliable.resize(count * lanes);
+		lane_sent_unacknowledged_reliable.resize(count * lanes);
+		lane_queue_time.resize(count * lanes);
+	}
+	all_status["count"] = count;
+	all_status["lanes"] = lanes;
+	all_status["connections"] = connections;
+	all_status["states"] = states;
+	all_status["pings"] = pings;
+	all_status["local_quality"] = local_quality;
+	all_status["remote_quality"] = remote_quality;
+	all_status["packets_out_per_second"] = packets_out_per_second;
+	all_status["bytes_out_per_second"] = bytes_out_per_second;
+	all_status["packets_in_per_second"] = packets_in_per_second;
+	all_status["bytes_in_per_second"] = bytes_in_per_second;
+	all_status["send_rate"] = send_rate;
+	all_status["pending_unreliable"] = pending_unreliable;
+	all_status["pending_reliable"] = pending_reliable;
+	all_status["sent_unacknowledged_reliable"] = sent_unacknowledged_reliable;
+	all_status["queue_time"] = queue_time;
+	if (lanes > 0) {
+		all_status["lane_pending_unreliable"] = lane_pending_unreliable;
+		all_status["lane_pending_reliable"] = lane_pending_reliable;
+		all_status["lane_sent_unacknowledged_reliable"] = lane_sent_unacknowledged_reliable;
+		all_status["lane_queue_time"] = lane_queue_time;
+	}
+	return all_status;
+}
+
+// Start a background thread that samples the real-time status of every registered connection every interval_usec microseconds.
+// Each connection keeps its last capacity samples; buffers are dropped when the connection leaves the registry. Returns false if the sampler is already running.
+bool SteamServer::startConnectionSampler(int interval_usec, int capacity) {
+	if (SteamNetworkingSockets() == NULL || connection_sampler_running.is_set() || interval_usec <= 0 || capacity <= 0) {
+		return false;
+	}
+	connection_sampler_interval = interval_usec;
+	connection_sampler_capacity = capacity;
+	callback_mutex.lock();
+	connection_sampler_mutex.lock();
+	connection_samples.clear();
+	for (const KeyValue<uint32, ConnectionRecord> &connection : connection_records) {
+		addConnectionSamples(connection.key);
+	}
+	connection_sampler_mutex.unlock();
+	callback_mutex.unlock();
+	connection_sampler_running.set();
+	connection_sampler_thread.start(connection_sampler_loop, this);
+	return true;
+}
+
+// Stop the connection sampler thread and free every sample buffer.
+void SteamServer::stopConnectionSampler() {
+	if (!connection_sampler_running.is_set()) {
+		return;
+	}
+	connection_sampler_running.clear();
+	connection_sampler_thread.wait_to_finish();
+	connection_sampler_mutex.lock();
+	connection_samples.clear();
+	connection_sampler_mutex.unlock();
+}
+
+// Get up to the last count samples for a connection, oldest first, as parallel packed arrays. Pass 0 to get every stored sample.
+Dictionary SteamServer::getConnectionSamples(uint32 connection_handle, int count) {
+	Dictionary samples;
+	MutexLock lock(connection_sampler_mutex);
+	HashMap<uint32, ConnectionSamples>::Iterator connection = connection_samples.find(connection_handle);
+	if (!connection) {
+		return samples;
+	}
+	const ConnectionSamples &ring = connection->value;
+	if (count <= 0 || count > ring.count) {
+		count = ring.count;
+	}
+	PackedInt64Array times;
+	times.resize(count);
+	PackedInt32Array pings;
+	pings.resize(count);
+	PackedFloat32Array local_quality;
+	local_quality.resize(count);
+	PackedFloat32Array remote_quality;
+	remote_quality.resize(count);
+	PackedFloat32Array bytes_in_per_second;
+	bytes_in_per_second.resize(count);
+	PackedFloat32Array bytes_out_per_second;
+	bytes_out_per_second.resize(count);
+	PackedInt64Array queue_time;
+	queue_time.resize(count);
+	int capacity = ring.samples.size();
+	// The oldest sample we return sits count places behind the next write
+	int first = (ring.next - count + capacity) % capacity;
+	for (int i = 0; i < count; i++) {
+		const ConnectionSample &sample = ring.samples[(first + i) % capacity];
+		times.set(i, sample.time);
+		pings.set(i, sample.ping);
+		local_quality.set(i, sample.local_quality);
+		remote_quality.set(i, sample.remote_quality);
+		bytes_in_per_second.set(i, sample.bytes_in_per_second);
+		bytes_out_per_second.set(i, sample.bytes_out_per_second);
+		queue_time.set(i, sample.queue_time);
+	}
+	samples["count"] = count;
+	samples["times"] = times;
+	samples["pings"] = pings;
+	samples["local_quality"] = local_quality;
+	samples["remote_quality"] = remote_quality;
+	samples["bytes_in_per_second"] = bytes_in_per_second;
+	samples["bytes_out_per_second"] = bytes_out_per_second;
+	samples["queue_time"] = queue_time;
+	return samples;
+}
+
+// Get the minimum, maximum, median and 99th percentile ping over a connection's stored samples. Samples without a ping measurement are skipped.
+Dictionary SteamServer::getConnectionPingStats(uint32 connection_handle) {
+	Dictionary ping_stats;
+	MutexLock lock(connection_sampler_mutex);
+	HashMap<uint32, ConnectionSamples>::Iterator connection = connection_samples.find(connection_handle);
+	if (!connection) {
+		return ping_stats;
+	}
+	const ConnectionSamples &ring = connection->value;
+	LocalVector<int> pings;
+	pings.reserve(ring.count);
+	for (int i = 0; i < ring.count; i++) {
+		if (ring.samples[i].ping >= 0) {
+			pings.push_back(ring.samples[i].ping);
+		}
+	}
+	ping_stats["count"] = pings.size();
+	if (pings.size() == 0) {
+		return ping_stats;
+	}
+	pings.sort();
+	int last = pings.size() - 1;
+	ping_stats["min"] = pings[0];
+	ping_stats["max"] = pings[last];
+	ping_stats["p50"] = pings[last * 50 / 100];
+	ping_stats["p99"] = pings[last * 99 / 100];
+	return ping_stats;
+}
+
+// Get a histogram of a connection's local quality over its stored samples, with buckets equal slices of 0 to 1.
+PackedInt32Array SteamServer::getConnectionQualityHistogram(uint32 connection_handle, int buckets) {
+	PackedInt32Array histogram;
+	if (buckets <= 0) {
+		return histogram;
+	}
+	MutexLock lock(connection_sampler_mutex);
+	HashMap<uint32, ConnectionSamples>::Iterator connection = connection_samples.find(connection_handle);
+	if (!connection) {
+		return histogram;
+	}
+	histogram.resize(buckets);
+	histogram.fill(0);
+	int32_t *histogram_data = histogram.ptrw();
+	const ConnectionSamples &ring = connection->value;
+	for (int i = 0; i < ring.count; i++) {
+		// Quality is negative when it has not been measured yet
+		float quality = ring.samples[i].local_quality;
+		if (quality < 0.0f) {
+			continue;
+		}
+		int bucket = CLAMP((int)(quality * buckets), 0, buckets - 1);
+		histogram_data[bucket]++;
+	}
+	return histogram;
+}
+
 // Configure multiple outbound messages streams ("lanes") on a connection, and control head-of-line blocking between them.
 // Messages within a given lane are always sent in the order they are queued, but messages from different lanes may be sent out of order.
 // Each lane has its own message number sequence.  The first message sent on each lane will be assigned the number 1.
@@ -2203,7 +5026,9 @@ void SteamServer::resetIdentity(uint64_t remote_steam_id) {
 // You don't need to call this if you are using Steam's callback dispatch mechanism (SteamAPI_RunCallbacks and SteamGameserver_RunCallbacks).
 void SteamServer::runNetworkingCallbacks() {
 	if (SteamNetworkingSockets() != NULL) {
-		SteamNetworkingSockets()->RunCallbacks();		
+		// Connection status handlers touch the native tables, so keep them from running alongside the callback thread
+		MutexLock lock(callback_mutex);
+		SteamNetworkingSockets()->RunCallbacks();
 	}
 }
 
@@ -2276,6 +5101,144 @@ void SteamServer::createFakeUDPPort(int fake_server_port_index) {
 	}
 }
 
+// Start a dedicated thread that keeps draining the given poll groups into a bounded ring, so socket draining is not tied to the main loop's frame time.
+// The ring holds ring_capacity messages, capped at NETWORK_RING_MAX_CAPACITY and rounded up to a power of two. When it is full the thread stops receiving and leaves messages queued in Steam until the main thread catches up.
+// Drain the ring from the main thread with drainNetworkThread, typically once per physics tick. Returns false if the thread is already running or there is nothing to poll.
+bool SteamServer::startNetworkThread(PackedInt32Array poll_groups, int ring_capacity, int max_messages, int idle_usec) {
+	if (SteamNetworkingSockets() == NULL || network_thread_running.is_set()) {
+		return false;
+	}
+	if (poll_groups.size() == 0 || ring_capacity <= 0 || max_messages <= 0) {
+		return false;
+	}
+	// Cap before rounding up so large sizes cannot wrap next_power_of_2 or allocate gigabytes
+	ring_capacity = MIN(ring_capacity, NETWORK_RING_MAX_CAPACITY);
+	max_messages = MIN(max_messages, ring_capacity);
+	network_thread_poll_groups.clear();
+	for (int i = 0; i < poll_groups.size(); i++) {
+		network_thread_poll_groups.push_back((uint32)poll_groups[i]);
+	}
+	network_ring_capacity = next_power_of_2((uint32_t)ring_capacity);
+	network_ring = new SteamNetworkingMessage_t*[network_ring_capacity];
+	network_ring_head.set(0);
+	network_ring_tail.set(0);
+	network_ring_high_watermark.set(0);
+	network_ring_full_stalls.set(0);
+	network_ring_received.set(0);
+	network_thread_max_messages = max_messages;
+	network_thread_idle_usec = MAX(idle_usec, 0);
+	network_thread_running.set();
+	network_thread.start(network_thread_loop, this);
+	return true;
+}
+
+// Stop the networking thread and release any messages still sitting in the ring.
+void SteamServer::stopNetworkThread() {
+	if (!network_thread_running.is_set()) {
+		return;
+	}
+	network_thread_running.clear();
+	network_thread.wait_to_finish();
+	// The thread is gone, so anything left in the ring is ours to release
+	uint32_t head = network_ring_head.get();
+	uint32_t tail = network_ring_tail.get();
+	while (head != tail) {
+		network_ring[head & (network_ring_capacity - 1)]->Release();
+		head++;
+	}
+	delete [] network_ring;
+	network_ring = NULL;
+	network_ring_capacity = 0;
+	network_ring_head.set(0);
+	network_ring_tail.set(0);
+}
+
+// Take up to max_messages from the networking thread's ring, in the same struct-of-arrays format as receiveMessagesOnPollGroupBatch.
+// Must only be called from one thread at a time, normally the main thread.
+Dictionary SteamServer::drainNetworkThread(int max_messages, bool unpack) {
+	Dictionary batch;
+	if (network_ring == NULL || max_messages <= 0) {
+		return batch;
+	}
+	uint32_t head = network_ring_head.get();
+	uint32_t tail = network_ring_tail.get();
+	int available_messages = MIN((int)(tail - head), max_messages);
+	// Copy the pointers out in order so the ring slots can be handed back right away
+	SteamNetworkingMessage_t** ring_messages = new SteamNetworkingMessage_t*[MAX(available_messages, 1)];
+	for (int i = 0; i < available_messages; i++) {
+		ring_messages[i] = network_ring[(head + i) & (network_ring_capacity - 1)];
+	}
+	network_ring_head.set(head + available_messages);
+	batch = packMessageBatch(ring_messages, available_messages, unpack);
+	delete [] ring_messages;
+	return batch;
+}
+
+// Get the number of messages waiting in the networking thread's ring.
+int SteamServer::getNetworkThreadQueueDepth() {
+	if (network_ring == NULL) {
+		return 0;
+	}
+	return (int)(network_ring_tail.get() - network_ring_head.get());
+}
+
+// Get the networking thread's state and queue metrics.
+Dictionary SteamServer::getNetworkThreadStatus() {
+	Dictionary status;
+	status["running"] = network_thread_running.is_set();
+	status["queue_depth"] = getNetworkThreadQueueDepth();
+	status["capacity"] = network_ring_capacity;
+	status["high_watermark"] = network_ring_high_watermark.get();
+	status["full_stalls"] = network_ring_full_stalls.get();
+	status["received"] = (uint64_t)network_ring_received.get();
+	return status;
+}
+
+// Networking thread body; the only producer for the ring
+void SteamServer::network_thread_loop(void *user_data) {
+	SteamServer *steam_server = (SteamServer *)user_data;
+	uint32_t capacity = steam_server->network_ring_capacity;
+	uint32_t mask = capacity - 1;
+	SteamNetworkingMessage_t** poll_messages = new SteamNetworkingMessage_t*[steam_server->network_thread_max_messages];
+	while (steam_server->network_thread_running.is_set()) {
+		int received_messages = 0;
+		bool ring_full = false;
+		for (uint32_t g = 0; g < steam_server->network_thread_poll_groups.size(); g++) {
+			uint32_t tail = steam_server->network_ring_tail.get();
+			uint32_t free_slots = capacity - (tail - steam_server->network_ring_head.get());
+			if (free_slots == 0) {
+				// Leave the rest queued in Steam rather than dropping anything
+				ring_full = true;
+				break;
+			}
+			if (SteamNetworkingSockets() == NULL) {
+				break;
+			}
+			int max_messages = MIN((int)free_slots, steam_server->network_thread_max_messages);
+			int available_messages = SteamNetworkingSockets()->ReceiveMessagesOnPollGroup((HSteamNetPollGroup)steam_server->network_thread_poll_groups[g], poll_messages, max_messages);
+			if (available_messages <= 0) {
+				continue;
+			}
+			for (int i = 0; i < available_messages; i++) {
+				steam_server->network_ring[(tail + i) & mask] = poll_messages[i];
+			}
+			// Publish the new messages to the main thread
+			steam_server->network_ring_tail.set(tail + available_messages);
+			steam_server->network_ring_high_watermark.exchange_if_greater(tail + available_messages - steam_server->network_ring_head.get());
+			steam_server->network_ring_received.add(available_messages);
+			received_messages += available_messages;
+		}
+		if (ring_full) {
+			steam_server->network_ring_full_stalls.increment();
+		}
+		if (received_messages == 0 || ring_full) {
+			OS::get_singleton()->delay_usec(steam_server->network_thread_idle_usec);
+		}
+	}
+	delete [] poll_messages;
+	SteamAPI_ReleaseCurrentThreadMemory();
+}
+
 
 ///// NETWORKING UTILS
 /////////////////////////////////////////////////
@@ -2530,13 +5493,15 @@ uint64_t SteamServer::getLocalTimestamp() {
 //
 // Adds a dependency between the given item and the appid. This list of dependencies can be retrieved by calling GetAppDependencies.
 // This is a soft-dependency that is displayed on the web. It is up to the application to determine whether the item can actually be used or not.
-void SteamServer::addAppDependency(uint64_t published_file_id, uint32_t app_id) {
+uint64_t SteamServer::addAppDependency(uint64_t published_file_id, uint32_t app_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
 		AppId_t app = (uint32_t)app_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->AddAppDependency(file_id, app);
-		callResultAddAppDependency.Set(api_call, this, &SteamServer::add_app_dependency_result);
+		return trackCallResult(api_call, &SteamServer::add_app_dependency_result, "addAppDependency");
 	}
+	return 0;
 }
 
 bool SteamServer::addContentDescriptor(uint64_t update_handle, int descriptor_id) {
@@ -2548,13 +5513,15 @@ bool SteamServer::addContentDescriptor(uint64_t update_handle, int descriptor_id
 
 // Adds a workshop item as a dependency to the specified item. If the nParentPublishedFileID item is of type k_EWorkshopFileTypeCollection, than the nChildPublishedFileID is simply added to that collection.
 // Otherwise, the dependency is a soft one that is displayed on the web and can be retrieved via the ISteamUGC API using a combination of the m_unNumChildren member variable of the SteamUGCDetails_t struct and GetQueryUGCChildren.
-void SteamServer::addDependency(uint64_t published_file_id, uint64_t child_published_file_id) {
+uint64_t SteamServer::addDependency(uint64_t published_file_id, uint64_t child_published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t parent = (uint64_t)published_file_id;
 		PublishedFileId_t child = (uint64_t)child_published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->AddDependency(parent, child);
-		callResultAddUGCDependency.Set(api_call, this, &SteamServer::add_ugc_dependency_result);
+		return trackCallResult(api_call, &SteamServer::add_ugc_dependency_result, "addDependency");
 	}
+	return 0;
 }
 
 // Adds a excluded tag to a pending UGC Query. This will only return UGC without the specified tag.
@@ -2593,13 +5560,15 @@ bool SteamServer::addItemPreviewVideo(uint64_t query_handle, const String& video
 }
 
 // Adds a workshop item to the users favorites list.
-void SteamServer::addItemToFavorites(uint32_t app_id, uint64_t published_file_id) {
+uint64_t SteamServer::addItemToFavorites(uint32_t app_id, uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		AppId_t app = (uint32_t)app_id;
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->AddItemToFavorites(app, file_id);
-		callResultFavoriteItemListChanged.Set(api_call, this, &SteamServer::user_favorite_items_list_changed);
+		return trackCallResult(api_call, &SteamServer::user_favorite_items_list_changed, "addItemToFavorites");
 	}
+	return 0;
 }
 
 // Adds a required key-value tag to a pending UGC Query. This will only return workshop items that have a key = pKey and a value = pValue.
@@ -2656,11 +5625,13 @@ bool SteamServer::initWorkshopForGameServer(uint32_t workshop_depot_id) {
 }
 
 // Creates a new workshop item with no content attached yet.
-void SteamServer::createItem(uint32 app_id, WorkshopFileType file_type) {
+uint64_t SteamServer::createItem(uint32 app_id, WorkshopFileType file_type) {
 	if (SteamUGC() != NULL) {
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->CreateItem((AppId_t)app_id, (EWorkshopFileType)file_type);
-		callResultItemCreate.Set(api_call, this, &SteamServer::item_created);
+		return trackCallResult(api_call, &SteamServer::item_created, "createItem");
 	}
+	return 0;
 }
 
 // Query for all matching UGC. You can use this to list all of the available UGC for your app.
@@ -2707,12 +5678,14 @@ uint64_t SteamServer::createQueryUserUGCRequest(uint64_t steam_id, UserUGCList l
 }
 
 // Deletes the item without prompting the user.
-void SteamServer::deleteItem(uint64_t published_file_id) {
+uint64_t SteamServer::deleteItem(uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->DeleteItem(file_id);
-		callResultDeleteItem.Set(api_call, this, &SteamServer::item_deleted);
+		return trackCallResult(api_call, &SteamServer::item_deleted, "deleteItem");
 	}
+	return 0;
 }
 
 // Download new or update already installed item. If returns true, wait for DownloadItemResult_t. If item is already installed, then files on disk should not be used until callback received.
@@ -3067,12 +6040,14 @@ Array SteamServer::getUserContentDescriptorPreferences(uint32 max_entries) {
 }
 
 // Gets the users vote status on a workshop item.
-void SteamServer::getUserItemVote(uint64_t published_file_id) {
+uint64_t SteamServer::getUserItemVote(uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->GetUserItemVote(file_id);
-		callResultGetUserItemVote.Set(api_call, this, &SteamServer::get_item_vote_result);
+		return trackCallResult(api_call, &SteamServer::get_item_vote_result, "getUserItemVote");
 	}
+	return 0;
 }
 
 // Releases a UGC query handle when you are done with it to free up memory.
@@ -3085,13 +6060,15 @@ bool SteamServer::releaseQueryUGCRequest(uint64_t query_handle) {
 }
 
 // Removes the dependency between the given item and the appid. This list of dependencies can be retrieved by calling GetAppDependencies.
-void SteamServer::removeAppDependency(uint64_t published_file_id, uint32_t app_id) {
+uint64_t SteamServer::removeAppDependency(uint64_t published_file_id, uint32_t app_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
 		AppId_t app = (uint32_t)app_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->RemoveAppDependency(file_id, app);
-		callResultRemoveAppDependency.Set(api_call, this, &SteamServer::remove_app_dependency_result);
+		return trackCallResult(api_call, &SteamServer::remove_app_dependency_result, "removeAppDependency");
 	}
+	return 0;
 }
 
 bool SteamServer::removeContentDescriptor(uint64_t update_handle, int descriptor_id) {
@@ -3102,23 +6079,27 @@ bool SteamServer::removeContentDescriptor(uint64_t update_handle, int descriptor
 }
 
 // Removes a workshop item as a dependency from the specified item.
-void SteamServer::removeDependency(uint64_t published_file_id, uint64_t child_published_file_id) {
+uint64_t SteamServer::removeDependency(uint64_t published_file_id, uint64_t child_published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
 		PublishedFileId_t childID = (uint64_t)child_published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->RemoveDependency(file_id, childID);
-		callResultRemoveUGCDependency.Set(api_call, this, &SteamServer::remove_ugc_dependency_result);
+		return trackCallResult(api_call, &SteamServer::remove_ugc_dependency_result, "removeDependency");
 	}
+	return 0;
 }
 
 // Removes a workshop item from the users favorites list.
-void SteamServer::removeItemFromFavorites(uint32_t app_id, uint64_t published_file_id) {
+uint64_t SteamServer::removeItemFromFavorites(uint32_t app_id, uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
 		AppId_t app = (uint32_t)app_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->RemoveItemFromFavorites(app, file_id);
-		callResultFavoriteItemListChanged.Set(api_call, this, &SteamServer::user_favorite_items_list_changed);
+		return trackCallResult(api_call, &SteamServer::user_favorite_items_list_changed, "removeItemFromFavorites");
 	}
+	return 0;
 }
 
 // Removes an existing key value tag from an item.
@@ -3140,12 +6121,14 @@ bool SteamServer::removeItemPreview(uint64_t update_handle, uint32 index) {
 }
 
 // Send a UGC query to Steam.
-void SteamServer::sendQueryUGCRequest(uint64_t update_handle) {
+uint64_t SteamServer::sendQueryUGCRequest(uint64_t update_handle) {
 	if (SteamUGC() != NULL) {
 		UGCUpdateHandle_t handle = uint64(update_handle);
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->SendQueryUGCRequest(handle);
-		callResultUGCQueryCompleted.Set(api_call, this, &SteamServer::ugc_query_completed);
+		return trackCallResult(api_call, &SteamServer::ugc_query_completed, "sendQueryUGCRequest");
 	}
+	return 0;
 }
 
 // Sets whether results will be returned from the cache for the specific period of time on a pending UGC Query.
@@ -3372,12 +6355,14 @@ bool SteamServer::setSearchText(uint64_t query_handle, const String& search_text
 }
 
 // Allows the user to rate a workshop item up or down.
-void SteamServer::setUserItemVote(uint64_t published_file_id, bool vote_up) {
+uint64_t SteamServer::setUserItemVote(uint64_t published_file_id, bool vote_up) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->SetUserItemVote(file_id, vote_up);
-		callResultSetUserItemVote.Set(api_call, this, &SteamServer::set_user_item_vote);
+		return trackCallResult(api_call, &SteamServer::set_user_item_vote, "setUserItemVote");
 	}
+	return 0;
 }
 
 // Starts the item update process.
@@ -3391,7 +6376,7 @@ uint64_t SteamServer::startItemUpdate(uint32_t app_id, uint64_t published_file_i
 }
 
 // Start tracking playtime on a set of workshop items.
-void SteamServer::startPlaytimeTracking(Array published_file_ids) {
+uint64_t SteamServer::startPlaytimeTracking(Array published_file_ids) {
 	if (SteamUGC() != NULL) {
 		uint32 fileCount = published_file_ids.size();
 		if (fileCount > 0) {
@@ -3399,15 +6384,18 @@ void SteamServer::startPlaytimeTracking(Array published_file_ids) {
 			for(uint32 i = 0; i < fileCount; i++) {
 				file_ids[i] = (uint64_t)published_file_ids[i];
 			}
+			MutexLock lock(callback_mutex);
 			SteamAPICall_t api_call = SteamUGC()->StartPlaytimeTracking(file_ids, fileCount);
-			callResultStartPlaytimeTracking.Set(api_call, this, &SteamServer::start_playtime_tracking);
+			trackCallResult(api_call, &SteamServer::start_playtime_tracking, "startPlaytimeTracking");
 			delete[] file_ids;
+			return api_call;
 		}
 	}
+	return 0;
 }
 
 // Stop tracking playtime on a set of workshop items.
-void SteamServer::stopPlaytimeTracking(Array published_file_ids) {
+uint64_t SteamServer::stopPlaytimeTracking(Array published_file_ids) {
 	if (SteamUGC() != NULL) {
 		uint32 fileCount = published_file_ids.size();
 		if (fileCount > 0) {
@@ -3416,51 +6404,62 @@ void SteamServer::stopPlaytimeTracking(Array published_file_ids) {
 			for(uint32 i = 0; i < fileCount; i++) {
 				file_ids[i] = (uint64_t)published_file_ids[i];
 			}
+			MutexLock lock(callback_mutex);
 			SteamAPICall_t api_call = SteamUGC()->StopPlaytimeTracking(file_ids, fileCount);
-			callResultStopPlaytimeTracking.Set(api_call, this, &SteamServer::stop_playtime_tracking);
+			trackCallResult(api_call, &SteamServer::stop_playtime_tracking, "stopPlaytimeTracking");
 			delete[] file_ids;
+			return api_call;
 		}
 	}
+	return 0;
 }
 
 // Stop tracking playtime of all workshop items.
-void SteamServer::stopPlaytimeTrackingForAllItems() {
+uint64_t SteamServer::stopPlaytimeTrackingForAllItems() {
 	if (SteamUGC() != NULL) {
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->StopPlaytimeTrackingForAllItems();
-		callResultStopPlaytimeTracking.Set(api_call, this, &SteamServer::stop_playtime_tracking);
+		return trackCallResult(api_call, &SteamServer::stop_playtime_tracking, "stopPlaytimeTrackingForAllItems");
 	}
+	return 0;
 }
 
 // Returns any app dependencies that are associated with the given item.
-void SteamServer::getAppDependencies(uint64_t published_file_id) {
+uint64_t SteamServer::getAppDependencies(uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->GetAppDependencies(file_id);
-		callResultGetAppDependencies.Set(api_call, this, &SteamServer::get_app_dependencies_result);
+		return trackCallResult(api_call, &SteamServer::get_app_dependencies_result, "getAppDependencies");
 	}
+	return 0;
 }
 
 // Uploads the changes made to an item to the Steam Workshop; to be called after setting your changes.
-void SteamServer::submitItemUpdate(uint64_t update_handle, const String& change_note) {
+uint64_t SteamServer::submitItemUpdate(uint64_t update_handle, const String& change_note) {
 	if (SteamUGC() != NULL) {
 		UGCUpdateHandle_t handle = uint64(update_handle);
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call;
 		if (change_note.is_empty()) {
 			api_call = SteamUGC()->SubmitItemUpdate(handle, NULL);
 		} else {
 			api_call = SteamUGC()->SubmitItemUpdate(handle, change_note.utf8().get_data());
 		}
-		callResultItemUpdate.Set(api_call, this, &SteamServer::item_updated);
+		return trackCallResult(api_call, &SteamServer::item_updated, "submitItemUpdate");
 	}
+	return 0;
 }
 
 // Subscribe to a workshop item. It will be downloaded and installed as soon as possible.
-void SteamServer::subscribeItem(uint64_t published_file_id) {
+uint64_t SteamServer::subscribeItem(uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->SubscribeItem(file_id);
-		callResultSubscribeItem.Set(api_call, this, &SteamServer::subscribe_item);
+		return trackCallResult(api_call, &SteamServer::subscribe_item, "subscribeItem");
 	}
+	return 0;
 }
 
 // SuspendDownloads( true ) will suspend all workshop downloads until SuspendDownloads( false ) is called or the game ends.
@@ -3471,12 +6470,14 @@ void SteamServer::suspendDownloads(bool suspend) {
 }
 
 // Unsubscribe from a workshop item. This will result in the item being removed after the game quits.
-void SteamServer::unsubscribeItem(uint64_t published_file_id) {
+uint64_t SteamServer::unsubscribeItem(uint64_t published_file_id) {
 	if (SteamUGC() != NULL) {
 		PublishedFileId_t file_id = (uint64_t)published_file_id;
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->UnsubscribeItem(file_id);
-		callResultUnsubscribeItem.Set(api_call, this, &SteamServer::unsubscribe_item);
+		return trackCallResult(api_call, &SteamServer::unsubscribe_item, "unsubscribeItem");
 	}
+	return 0;
 }
 
 // Updates an existing additional preview file for the item.
@@ -3506,11 +6507,13 @@ bool SteamServer::showWorkshopEULA() {
 }
 
 // Retrieve information related to the user's acceptance or not of the app's specific Workshop EULA.
-void SteamServer::getWorkshopEULAStatus() {
+uint64_t SteamServer::getWorkshopEULAStatus() {
 	if (SteamUGC() != NULL) {
+		MutexLock lock(callback_mutex);
 		SteamAPICall_t api_call = SteamUGC()->GetWorkshopEULAStatus();
-		callResultWorkshopEULAStatus.Set(api_call, this, &SteamServer::workshop_eula_status);
+		return trackCallResult(api_call, &SteamServer::workshop_eula_status, "getWorkshopEULAStatus");
 	}
+	return 0;
 }
 
 // Set the time range this item was created.
@@ -3541,46 +6544,71 @@ bool SteamServer::setTimeUpdatedDateRange(uint64_t update_handle, uint32 start,
 void SteamServer::server_connect_failure(SteamServerConnectFailure_t* server_data) {
 	int result = server_data->m_eResult;
 	bool retrying = server_data->m_bStillRetrying;
-	emit_signal("server_connect_failure", result, retrying);
+	emitCallbackSignal("server_connect_failure", result, retrying);
 }
 
 // Server has connected to the Steam back-end; server_data has no fields.
 void SteamServer::server_connected(SteamServersConnected_t* server_data) {
-	emit_signal("server_connected");
+	emitCallbackSignal("server_connected");
 }
 
 // Called if the client has lost connection to the Steam servers. Real-time services will be disabled until a matching SteamServersConnected_t has been posted.
 void SteamServer::server_disconnected(SteamServersDisconnected_t* server_data) {
 	int result = server_data->m_eResult;
-	emit_signal("server_disconnected", result);
+	emitCallbackSignal("server_disconnected", result);
 }
 
 // Client has been approved to connect to this game server.
 void SteamServer::client_approved(GSClientApprove_t* client_data) {
 	uint64_t steam_id = client_data->m_SteamID.ConvertToUint64();
 	uint64_t owner_id = client_data->m_OwnerSteamID.ConvertToUint64();
-	emit_signal("client_approved", steam_id, owner_id);
+	HashMap<uint64_t, AuthSession>::Iterator session = auth_sessions.find(steam_id);
+	if (session) {
+		session->value.state = AUTH_SESSION_STATE_APPROVED;
+		session->value.owner_id = owner_id;
+	}
+	if (event_queue_enabled) {
+		queueEvent(EVENT_CLIENT_APPROVED, 0, steam_id, 0, 0, 0, owner_id);
+		return;
+	}
+	emitCallbackSignal("client_approved", steam_id, owner_id);
 }
 
 // Client has been denied to connection to this game server.
 void SteamServer::client_denied(GSClientDeny_t* client_data) {
 	uint64_t steam_id = client_data->m_SteamID.ConvertToUint64();
 	SteamServer::DenyReason reason = (SteamServer::DenyReason)client_data->m_eDenyReason;
-	emit_signal("client_denied", steam_id, reason);
+	HashMap<uint64_t, AuthSession>::Iterator session = auth_sessions.find(steam_id);
+	if (session) {
+		session->value.state = AUTH_SESSION_STATE_DENIED;
+	}
+	if (event_queue_enabled) {
+		queueEvent(EVENT_CLIENT_DENIED, 0, steam_id, reason);
+		return;
+	}
+	emitCallbackSignal("client_denied", steam_id, reason);
 }
 
 // Request the game server should kick the user.
 void SteamServer::client_kick(GSClientKick_t* client_data) {
 	uint64_t steam_id = client_data->m_SteamID.ConvertToUint64();
 	SteamServer::DenyReason reason = (SteamServer::DenyReason)client_data->m_eDenyReason;
-	emit_signal("client_kick", steam_id, reason);
+	{
+		MutexLock lock(callback_mutex);
+		licence_cache.erase(steam_id);
+	}
+	if (event_queue_enabled) {
+		queueEvent(EVENT_CLIENT_KICK, 0, steam_id, reason);
+		return;
+	}
+	emitCallbackSignal("client_kick", steam_id, reason);
 }
 
 // Received when the game server requests to be displayed as secure (VAC protected).
 // m_bSecure is true if the game server should display itself as secure to users, false otherwise.
 void SteamServer::policy_response(GSPolicyResponse_t* policy_data) {
 	uint8 secure = policy_data->m_bSecure;
-	emit_signal("policy_response", secure);
+	emitCallbackSignal("policy_response", secure);
 }
 
 // Sent as a reply to RequestUserGroupStatus().
@@ -3589,13 +6617,13 @@ void SteamServer::client_group_status(GSClientGroupStatus_t* client_data) {
 	uint64_t group_id = client_data->m_SteamIDGroup.ConvertToUint64();
 	bool member = client_data->m_bMember;
 	bool officer = client_data->m_bOfficer;
-	emit_signal("client_group_status", steam_id, group_id, member, officer);
+	emitCallbackSignal("client_group_status", steam_id, group_id, member, officer);
 }
 
 // Sent as a reply to AssociateWithClan().
 void SteamServer::associate_clan(AssociateWithClanResult_t* clan_data) {
 	SteamServer::Result result = (SteamServer::Result)clan_data->m_eResult;
-	emit_signal("associate_clan", result);
+	emitCallbackSignal("associate_clan", result);
 }
 
 // Sent as a reply to ComputeNewPlayerCompatibility().
@@ -3605,7 +6633,21 @@ void SteamServer::player_compat(ComputeNewPlayerCompatibilityResult_t* player_da
 	int players_candidate_doesnt_like = player_data->m_cPlayersThatCandidateDoesntLike;
 	int clan_players_dont_like_candidate = player_data->m_cClanPlayersThatDontLikeCandidate;
 	uint64_t steam_id = player_data->m_SteamIDCandidate.ConvertToUint64();
-	emit_signal("player_compat", result, players_dont_like_candidate, players_candidate_doesnt_like, clan_players_dont_like_candidate, steam_id);
+	emitCallbackSignal("player_compat", result, players_dont_like_candidate, players_candidate_doesnt_like, clan_players_dont_like_candidate, steam_id);
+}
+
+// Result of a ticket passed to beginAuthSession; Steam keeps validating the ticket for as long as the session lasts, so this can arrive more than once.
+void SteamServer::validate_auth_ticket_response(ValidateAuthTicketResponse_t* call_data) {
+	uint64_t steam_id = call_data->m_SteamID.ConvertToUint64();
+	int response = call_data->m_eAuthSessionResponse;
+	uint64_t owner_id = call_data->m_OwnerSteamID.ConvertToUint64();
+	HashMap<uint64_t, AuthSession>::Iterator session = auth_sessions.find(steam_id);
+	if (session) {
+		session->value.state = (response == k_EAuthSessionResponseOK) ? AUTH_SESSION_STATE_APPROVED : AUTH_SESSION_STATE_DENIED;
+		session->value.response = response;
+		session->value.owner_id = owner_id;
+	}
+	emitCallbackSignal("validate_auth_ticket_response", steam_id, response, owner_id);
 }
 
 // GAME SERVER STATS CALLBACKS //////////////////
@@ -3614,20 +6656,40 @@ void SteamServer::player_compat(ComputeNewPlayerCompatibilityResult_t* player_da
 void SteamServer::stats_received(GSStatsReceived_t* callData, bool bioFailure) {
 	EResult result = callData->m_eResult;
 	uint64_t steam_id = callData->m_steamIDUser.ConvertToUint64();
-	emit_signal("stats_received", result, steam_id);
+	emitCallbackSignal("stats_received", result, steam_id);
 }
 
 // Result of a request to store the user stats.
 void SteamServer::stats_stored(GSStatsStored_t* callData) {
 	EResult result = callData->m_eResult;
 	uint64_t steam_id = callData->m_steamIDUser.ConvertToUint64();
-	emit_signal("stats_stored", result, steam_id);
+	// Failed stores are retried with exponential backoff
+	{
+		MutexLock lock(callback_mutex);
+		StatsBuffer *buffer = stats_buffers.getptr(steam_id);
+		if (buffer != NULL && buffer->storing) {
+			// The buffer stays until the player's stats are unloaded so their checked names are kept
+			if (result == k_EResultOK) {
+				buffer->storing = false;
+				buffer->failures = 0;
+				buffer->retry_usec = 0;
+			}
+			else {
+				retryStatsStore(*buffer, OS::get_singleton()->get_ticks_usec());
+			}
+		}
+	}
+	emitCallbackSignal("stats_stored", result, steam_id);
 }
 
 // Callback indicating that a user's stats have been unloaded.
 void SteamServer::stats_unloaded(GSStatsUnloaded_t* callData) {
 	uint64_t steam_id = callData->m_steamIDUser.ConvertToUint64();
-	emit_signal("stats_unloaded", steam_id);
+	{
+		MutexLock lock(callback_mutex);
+		stats_buffers.erase(steam_id);
+	}
+	emitCallbackSignal("stats_unloaded", steam_id);
 }
 
 // HTTP CALLBACKS ///////////////////////////////
@@ -3639,7 +6701,7 @@ void SteamServer::http_request_completed(HTTPRequestCompleted_t* call_data) {
 	bool request_success = call_data->m_bRequestSuccessful;
 	int status_code = call_data->m_eStatusCode;
 	uint32 body_size = call_data->m_unBodySize;
-	emit_signal("http_request_completed", cookie_handle, context_value, request_success, status_code, body_size);
+	emitCallbackSignal("http_request_completed", cookie_handle, context_value, request_success, status_code, body_size);
 }
 
 //! Triggered when a chunk of data is received from a streaming HTTP request.
@@ -3648,14 +6710,14 @@ void SteamServer::http_request_data_received(HTTPRequestDataReceived_t* call_dat
 	uint64_t context_value = call_data->m_ulContextValue;
 	uint32 offset = call_data->m_cOffset;
 	uint32 bytes_received = call_data->m_cBytesReceived;
-	emit_signal("http_request_data_received", cookie_handle, context_value, offset, bytes_received);
+	emitCallbackSignal("http_request_data_received", cookie_handle, context_value, offset, bytes_received);
 }
 
 //! Triggered when HTTP headers are received from a streaming HTTP request.
 void SteamServer::http_request_headers_received(HTTPRequestHeadersReceived_t* call_data) {
 	uint32 cookie_handle = call_data->m_hRequest;
 	uint64_t context_value = call_data->m_ulContextValue;
-	emit_signal("http_request_headers_received", cookie_handle, context_value);
+	emitCallbackSignal("http_request_headers_received", cookie_handle, context_value);
 }
 
 // INVENTORY CALLBACKS //////////////////////////
@@ -3679,7 +6741,7 @@ void SteamServer::inventory_definition_update(SteamInventoryDefinitionUpdate_t *
 		delete[] id_array;
 	}
 	// Return the item array as a signal
-	emit_signal("inventory_defintion_update", definitions);
+	emitCallbackSignal("inventory_defintion_update", definitions);
 }
 
 // Triggered when GetAllItems successfully returns a result which is newer / fresher than the last known result. (It will not trigger if the inventory hasn't changed, or if results from two overlapping calls are reversed in flight and the earlier result is already known to be stale/out-of-date.)
@@ -3688,7 +6750,7 @@ void SteamServer::inventory_full_update(SteamInventoryFullUpdate_t *call_data) {
 	// Set the handle
 	inventory_handle = call_data->m_handle;
 	// Send the handle back to the user
-	emit_signal("inventory_full_update", call_data->m_handle);
+	emitCallbackSignal("inventory_full_update", call_data->m_handle);
 }
 
 // This is fired whenever an inventory result transitions from k_EResultPending to any other completed state, see GetResultStatus for the complete list of states. There will always be exactly one callback per handle.
@@ -3697,7 +6759,7 @@ void SteamServer::inventory_result_ready(SteamInventoryResultReady_t *call_data)
 	int result = call_data->m_result;
 	// Get the handle and pass it over
 	inventory_handle = call_data->m_handle;
-	emit_signal("inventory_result_ready", result, inventory_handle);
+	emitCallbackSignal("inventory_result_ready", result, inventory_handle);
 }
 
 // NETWORKING CALLBACKS /////////////////////////
@@ -3706,20 +6768,28 @@ void SteamServer::inventory_result_ready(SteamInventoryResultReady_t *call_data)
 void SteamServer::p2p_session_connect_fail(P2PSessionConnectFail_t* call_data) {
 	uint64_t remote_steam_id = call_data->m_steamIDRemote.ConvertToUint64();
 	uint8_t session_error = call_data->m_eP2PSessionError;
-	emit_signal("p2p_session_connect_fail", remote_steam_id, session_error);
+	emitCallbackSignal("p2p_session_connect_fail", remote_steam_id, session_error);
 }
 
 // A user wants to communicate with us over the P2P channel via the sendP2PPacket. In response, a call to acceptP2PSessionWithUser needs to be made, if you want to open the network channel with them.
 void SteamServer::p2p_session_request(P2PSessionRequest_t* call_data) {
 	uint64_t remote_steam_id = call_data->m_steamIDRemote.ConvertToUint64();
-	emit_signal("p2p_session_request", remote_steam_id);
+	if (event_queue_enabled) {
+		queueEvent(EVENT_P2P_SESSION_REQUEST, 0, remote_steam_id);
+		return;
+	}
+	emitCallbackSignal("p2p_session_request", remote_steam_id);
 }
 
 // NETWORKING MESSAGES CALLBACKS ////////////////
 //
 // Posted when a remote host is sending us a message, and we do not already have a session with them.
 void SteamServer::network_messages_session_request(SteamNetworkingMessagesSessionRequest_t* call_data) {
-	emit_signal("network_messages_session_request", getSteamIDFromIdentity(call_data->m_identityRemote));
+	if (event_queue_enabled) {
+		queueEvent(EVENT_NETWORK_MESSAGES_SESSION_REQUEST, 0, getSteamIDFromIdentity(call_data->m_identityRemote));
+		return;
+	}
+	emitCallbackSignal("network_messages_session_request", getSteamIDFromIdentity(call_data->m_identityRemote));
 }
 
 // Posted when we fail to establish a connection, or we detect that communications have been disrupted it an unusual way.
@@ -3727,7 +6797,7 @@ void SteamServer::network_messages_session_failed(SteamNetworkingMessagesSession
 	SteamNetConnectionInfo_t info = call_data->m_info;
 	// Parse out the reason for failure
 	int reason = info.m_eEndReason;
-	emit_signal("network_messages_session_failed", reason);
+	emitCallbackSignal("network_messages_session_failed", reason);
 }
 
 // NETWORKING SOCKETS CALLBACKS /////////////////
@@ -3738,6 +6808,27 @@ void SteamServer::network_connection_status_changed(SteamNetConnectionStatusChan
 	uint64_t connect_handle = call_data->m_hConn;
 	// Full connection info.
 	SteamNetConnectionInfo_t connection_info = call_data->m_info;
+	// Previous state (current state is in m_info.m_eState).
+	int old_state = call_data->m_eOldState;
+	// Keep the connection registry current before scripts hear about the change
+	if (connection_info.m_eState == k_ESteamNetworkingConnectionState_Connecting || connection_info.m_eState == k_ESteamNetworkingConnectionState_FindingRoute || connection_info.m_eState == k_ESteamNetworkingConnectionState_Connected) {
+		updateConnectionRecord(call_data->m_hConn, connection_info);
+	}
+	else {
+		// Also ends the player's auth session and stores their stats once their last connection is gone
+		removeConnectionRecord(call_data->m_hConn);
+	}
+	// New incoming connections are settled by the admission policy, if there is one
+	// A rejected connection is already closed, so scripts only hear about it through admission_summary
+	if (admission_enabled && call_data->m_eOldState == k_ESteamNetworkingConnectionState_None && connection_info.m_eState == k_ESteamNetworkingConnectionState_Connecting && connection_info.m_hListenSocket != k_HSteamListenSocket_Invalid) {
+		if (!admitConnection(call_data->m_hConn, connection_info)) {
+			return;
+		}
+	}
+	if (event_queue_enabled) {
+		queueEvent(EVENT_NETWORK_CONNECTION_STATUS_CHANGED, call_data->m_hConn, getSteamIDFromIdentity(connection_info.m_identityRemote), connection_info.m_eState, old_state, connection_info.m_eEndReason);
+		return;
+	}
 	// Move connection info into a dictionary
 	Dictionary connection;
 	connection["identity"] = getSteamIDFromIdentity(connection_info.m_identityRemote);
@@ -3750,10 +6841,8 @@ void SteamServer::network_connection_status_changed(SteamNetConnectionStatusChan
 	connection["end_reason"] = connection_info.m_eEndReason;
 	connection["end_debug"] = connection_info.m_szEndDebug;
 	connection["debug_description"] = connection_info.m_szConnectionDescription;
-	// Previous state (current state is in m_info.m_eState).
-	int old_state = call_data->m_eOldState;
 	// Send the data back via signal
-	emit_signal("network_connection_status_changed", connect_handle, connection, old_state);
+	emitCallbackSignal("network_connection_status_changed", connect_handle, connection, old_state);
 }
 
 // This callback is posted whenever the state of our readiness changes.
@@ -3764,7 +6853,7 @@ void SteamServer::network_authentication_status(SteamNetAuthenticationStatus_t*
 	char *debug_message = new char[256];
 	sprintf(debug_message, "%s", call_data->m_debugMsg);
 	// Send the data back via signal
-	emit_signal("network_authentication_status", available, debug_message);
+	emitCallbackSignal("network_authentication_status", available, debug_message);
 	delete[] debug_message;
 }
 
@@ -3779,7 +6868,7 @@ void SteamServer::fake_ip_result(SteamNetworkingFakeIPResult_t* call_data) {
 	for (uint16 i = 0; i < sizeof(ports); i++) {
 		port_list.append(ports[i]);
 	}
-	emit_signal("fake_ip_result", result, getSteamIDFromIdentity(call_data->m_identity), getStringFromIP(fake_ip), port_list);
+	emitCallbackSignal("fake_ip_result", result, getSteamIDFromIdentity(call_data->m_identity), getStringFromIP(fake_ip), port_list);
 }
 
 // NETWORKING UTILS CALLBACKS ///////////////////
@@ -3793,7 +6882,7 @@ void SteamServer::relay_network_status(SteamRelayNetworkStatus_t* call_data) {
 	char *debug_message = new char[256];
 	snprintf(debug_message, 256, "%s", call_data->m_debugMsg);
 //	debug_message = call_data->m_debugMsg;
-	emit_signal("relay_network_status", available, ping_measurement, available_config, available_relay, debug_message);
+	emitCallbackSignal("relay_network_status", available, ping_measurement, available_config, available_relay, debug_message);
 	delete[] debug_message;
 }
 
@@ -3802,7 +6891,7 @@ void SteamServer::relay_network_status(SteamRelayNetworkStatus_t* call_data) {
 // Purpose: one or more files for this app have changed locally after syncing to remote session changes.
 // Note: only posted if this happens DURING the local app session.
 void SteamServer::local_file_changed(RemoteStorageLocalFileChange_t* call_data) {
-	emit_signal("local_file_changed");
+	emitCallbackSignal("local_file_changed");
 }
 
 // UGC CALLBACKS ////////////////////////////////
@@ -3812,20 +6901,20 @@ void SteamServer::item_downloaded(DownloadItemResult_t* call_data) {
 	EResult result = call_data->m_eResult;
 	PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 	AppId_t app_id = call_data->m_unAppID;
-	emit_signal("item_downloaded", result, (uint64_t)file_id, (uint32_t)app_id);
+	emitCallbackSignal("item_downloaded", result, (uint64_t)file_id, (uint32_t)app_id);
 }
 
 // Called when a workshop item has been installed or updated.
 void SteamServer::item_installed(ItemInstalled_t* call_data) {
 	AppId_t app_id = call_data->m_unAppID;
 	PublishedFileId_t file_id = call_data->m_nPublishedFileId;
-	emit_signal("item_installed", app_id, (uint64_t)file_id);
+	emitCallbackSignal("item_installed", app_id, (uint64_t)file_id);
 }
 
 // Purpose: signal that the list of subscribed items changed.
 void SteamServer::user_subscribed_items_list_changed(UserSubscribedItemsListChanged_t* call_data) {
 	uint32 app_id = call_data->m_nAppID;
-	emit_signal("user_subscribed_items_list_changed", app_id);
+	emitCallbackSignal("user_subscribed_items_list_changed", app_id);
 }
 
 
@@ -3837,7 +6926,7 @@ void SteamServer::user_subscribed_items_list_changed(UserSubscribedItemsListChan
 //! Intended to serve as generic error messaging for failed call results
 void SteamServer::steamworksError(const String& failed_signal) {
 	// Emit the signal to inform the user of the failure
-	emit_signal("steamworks_error", failed_signal, "io failure");
+	emitCallbackSignal("steamworks_error", failed_signal, "io failure");
 }
 
 // INVENTORY CALL RESULTS ///////////////////////
@@ -3869,7 +6958,7 @@ void SteamServer::inventory_eligible_promo_item(SteamInventoryEligiblePromoItemD
 		// Delete the temporary array
 		delete[] id_array;
 		// Return the item array as a signal
-		emit_signal("inventory_eligible_promo_Item", result, cached, definitions);
+		emitCallbackSignal("inventory_eligible_promo_Item", result, cached, definitions);
 	}
 }
 
@@ -3882,10 +6971,10 @@ void SteamServer::inventory_start_purchase_result(SteamInventoryStartPurchaseRes
 		if (call_data->m_result == k_EResultOK) {
 			uint64_t order_id = call_data->m_ulOrderID;
 			uint64_t transaction_id = call_data->m_ulTransID;
-			emit_signal("inventory_start_purchase_result", "success", order_id, transaction_id);
+			emitCallbackSignal("inventory_start_purchase_result", "success", order_id, transaction_id);
 		}
 		else{
-			emit_signal("inventory_start_purchase_result", "failure", 0, 0);
+			emitCallbackSignal("inventory_start_purchase_result", "failure", 0, 0);
 		}
 	}
 }
@@ -3898,7 +6987,7 @@ void SteamServer::inventory_request_prices_result(SteamInventoryRequestPricesRes
 	else{
 		int result = call_data->m_result;
 		String currency = call_data->m_rgchCurrency;
-		emit_signal("inventory_request_prices_result", result, currency);
+		emitCallbackSignal("inventory_request_prices_result", result, currency);
 	}
 }
 
@@ -3926,7 +7015,7 @@ void SteamServer::file_read_async_complete(RemoteStorageFileReadAsyncComplete_t*
 		file_read["offset"] = offset;
 		file_read["read"] = read;
 		file_read["complete"] = complete;
-		emit_signal("file_read_async_complete", file_read);
+		emitCallbackSignal("file_read_async_complete", file_read);
 	}
 }
 
@@ -3940,7 +7029,7 @@ void SteamServer::file_share_result(RemoteStorageFileShareResult_t* call_data, b
 		uint64_t handle = call_data->m_hFile;
 		char name[k_cchFilenameMax];
 		strcpy(name, call_data->m_rgchFilename);
-		emit_signal("file_share_result", result, handle, name);
+		emitCallbackSignal("file_share_result", result, handle, name);
 	}
 }
 
@@ -3951,7 +7040,7 @@ void SteamServer::file_write_async_complete(RemoteStorageFileWriteAsyncComplete_
 	}
 	else{
 		int result = call_data->m_eResult;
-		emit_signal("file_write_async_complete", result);
+		emitCallbackSignal("file_write_async_complete", result);
 	}
 }
 
@@ -3975,7 +7064,7 @@ void SteamServer::download_ugc_result(RemoteStorageDownloadUGCResult_t* call_dat
 		download_data["size"] = size;
 		download_data["filename"] = filename;
 		download_data["owner_id"] = owner_id;
-		emit_signal("download_ugc_result", result, download_data);
+		emitCallbackSignal("download_ugc_result", result, download_data);
 	}
 }
 
@@ -3987,7 +7076,7 @@ void SteamServer::unsubscribe_item(RemoteStorageUnsubscribePublishedFileResult_t
 	else{
 		int result = call_data->m_eResult;
 		int file_id = call_data->m_nPublishedFileId;
-		emit_signal("unsubscribe_item", result, file_id);
+		emitCallbackSignal("unsubscribe_item", result, file_id);
 	}
 }
 
@@ -3999,7 +7088,7 @@ void SteamServer::subscribe_item(RemoteStorageSubscribePublishedFileResult_t* ca
 	else{
 		int result = call_data->m_eResult;
 		int file_id = call_data->m_nPublishedFileId;
-		emit_signal("subscribe_item", result, file_id);
+		emitCallbackSignal("subscribe_item", result, file_id);
 	}
 }
 
@@ -4014,7 +7103,7 @@ void SteamServer::add_app_dependency_result(AddAppDependencyResult_t* call_data,
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		AppId_t app_id = call_data->m_nAppID;
-		emit_signal("add_app_dependency_result", result, (uint64_t)file_id, (uint32_t)app_id);
+		emitCallbackSignal("add_app_dependency_result", result, (uint64_t)file_id, (uint32_t)app_id);
 	}
 }
 
@@ -4027,7 +7116,7 @@ void SteamServer::add_ugc_dependency_result(AddUGCDependencyResult_t* call_data,
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		PublishedFileId_t child_id = call_data->m_nChildPublishedFileId;
-		emit_signal("add_ugc_dependency_result", result, (uint64_t)file_id, (uint64_t)child_id);
+		emitCallbackSignal("add_ugc_dependency_result", result, (uint64_t)file_id, (uint64_t)child_id);
 	}
 }
 
@@ -4040,7 +7129,7 @@ void SteamServer::item_created(CreateItemResult_t *call_data, bool io_failure) {
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		bool accept_tos = call_data->m_bUserNeedsToAcceptWorkshopLegalAgreement;
-		emit_signal("item_created", result, (uint64_t)file_id, accept_tos);
+		emitCallbackSignal("item_created", result, (uint64_t)file_id, accept_tos);
 	}
 }
 
@@ -4055,8 +7144,8 @@ void SteamServer::get_app_dependencies_result(GetAppDependenciesResult_t* call_d
 //		AppId_t app_id = call_data->m_rgAppIDs;
 		uint32 app_dependencies = call_data->m_nNumAppDependencies;
 		uint32 total_app_dependencies = call_data->m_nTotalNumAppDependencies;
-//		emit_signal("get_app_dependencies_result", result, (uint64_t)file_id, app_id, appDependencies, totalAppDependencies);
-		emit_signal("get_app_dependencies_result", result, (uint64_t)file_id, app_dependencies, total_app_dependencies);
+//		emitCallbackSignal("get_app_dependencies_result", result, (uint64_t)file_id, app_id, appDependencies, totalAppDependencies);
+		emitCallbackSignal("get_app_dependencies_result", result, (uint64_t)file_id, app_dependencies, total_app_dependencies);
 	}
 }
 
@@ -4068,7 +7157,7 @@ void SteamServer::item_deleted(DeleteItemResult_t* call_data, bool io_failure) {
 	else{
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
-		emit_signal("item_deleted", result, (uint64_t)file_id);
+		emitCallbackSignal("item_deleted", result, (uint64_t)file_id);
 	}
 }
 
@@ -4083,7 +7172,7 @@ void SteamServer::get_item_vote_result(GetUserItemVoteResult_t* call_data, bool
 		bool vote_up = call_data->m_bVotedUp;
 		bool vote_down = call_data->m_bVotedDown;
 		bool vote_skipped = call_data->m_bVoteSkipped;
-		emit_signal("get_item_vote_result", result, (uint64_t)file_id, vote_up, vote_down, vote_skipped);
+		emitCallbackSignal("get_item_vote_result", result, (uint64_t)file_id, vote_up, vote_down, vote_skipped);
 	}
 }
 
@@ -4096,7 +7185,7 @@ void SteamServer::remove_app_dependency_result(RemoveAppDependencyResult_t* call
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		AppId_t app_id = call_data->m_nAppID;
-		emit_signal("remove_app_dependency_result", result, (uint64_t)file_id, (uint32_t)app_id);
+		emitCallbackSignal("remove_app_dependency_result", result, (uint64_t)file_id, (uint32_t)app_id);
 	}
 }
 
@@ -4109,7 +7198,7 @@ void SteamServer::remove_ugc_dependency_result(RemoveUGCDependencyResult_t* call
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		PublishedFileId_t child_id = call_data->m_nChildPublishedFileId;
-		emit_signal("remove_ugc_dependency_result", result, (uint64_t)file_id, (uint64_t)child_id);
+		emitCallbackSignal("remove_ugc_dependency_result", result, (uint64_t)file_id, (uint64_t)child_id);
 	}
 }
 
@@ -4122,7 +7211,7 @@ void SteamServer::set_user_item_vote(SetUserItemVoteResult_t* call_data, bool io
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		bool vote_up = call_data->m_bVoteUp;
-		emit_signal("set_user_item_vote", result, (uint64_t)file_id, vote_up);
+		emitCallbackSignal("set_user_item_vote", result, (uint64_t)file_id, vote_up);
 	}
 }
 
@@ -4133,7 +7222,7 @@ void SteamServer::start_playtime_tracking(StartPlaytimeTrackingResult_t* call_da
 	}
 	else{
 		EResult result = call_data->m_eResult;
-		emit_signal("start_playtime_tracking", result);
+		emitCallbackSignal("start_playtime_tracking", result);
 	}
 }
 
@@ -4148,7 +7237,7 @@ void SteamServer::ugc_query_completed(SteamUGCQueryCompleted_t* call_data, bool
 		uint32 results_returned = call_data->m_unNumResultsReturned;
 		uint32 total_matching = call_data->m_unTotalMatchingResults;
 		bool cached = call_data->m_bCachedData;
-		emit_signal("ugc_query_completed", (uint64_t)handle, result, results_returned, total_matching, cached);
+		emitCallbackSignal("ugc_query_completed", (uint64_t)handle, result, results_returned, total_matching, cached);
 	}
 }
 
@@ -4159,7 +7248,7 @@ void SteamServer::stop_playtime_tracking(StopPlaytimeTrackingResult_t* call_data
 	}
 	else{
 		EResult result = call_data->m_eResult;
-		emit_signal("stop_playtime_tracking", result);
+		emitCallbackSignal("stop_playtime_tracking", result);
 	}
 }
 
@@ -4171,7 +7260,7 @@ void SteamServer::item_updated(SubmitItemUpdateResult_t *call_data, bool io_fail
 	else{
 		EResult result = call_data->m_eResult;
 		bool need_to_accept_tos = call_data->m_bUserNeedsToAcceptWorkshopLegalAgreement;
-		emit_signal("item_updated", result, need_to_accept_tos);
+		emitCallbackSignal("item_updated", result, need_to_accept_tos);
 	}
 }
 
@@ -4184,7 +7273,7 @@ void SteamServer::user_favorite_items_list_changed(UserFavoriteItemsListChanged_
 		EResult result = call_data->m_eResult;
 		PublishedFileId_t file_id = call_data->m_nPublishedFileId;
 		bool was_add_request = call_data->m_bWasAddRequest;
-		emit_signal("user_favorite_items_list_changed", result, (uint64_t)file_id, was_add_request);
+		emitCallbackSignal("user_favorite_items_list_changed", result, (uint64_t)file_id, was_add_request);
 	}
 }
 
@@ -4202,7 +7291,7 @@ void SteamServer::workshop_eula_status(WorkshopEULAStatus_t* call_data, bool io_
 		eula_data["action"] = call_data->m_rtAction;			// int
 		eula_data["accepted"] = call_data->m_bAccepted;			// bool
 		eula_data["needs_action"] = call_data->m_bNeedsAction;	// bool
-		emit_signal("workshop_eula_status", result, app_id, eula_data);
+		emitCallbackSignal("workshop_eula_status", result, app_id, eula_data);
 	}
 }
 
@@ -4216,6 +7305,9 @@ void SteamServer::_bind_methods() {
 	/////////////////////////////////////////////
 	//
 	// MAIN BIND METHODS ////////////////////////
+	ClassDB::bind_method(D_METHOD("enableManualDispatch", "subsystems", "budget_usec"), &SteamServer::enableManualDispatch, DEFVAL(CALLBACK_SUBSYSTEM_ALL), DEFVAL(0));
+	ClassDB::bind_method("getCallbackSubsystems", &SteamServer::getCallbackSubsystems);
+	ClassDB::bind_method("getCallResultMetrics", &SteamServer::getCallResultMetrics);
 	ClassDB::bind_method("getServerSteamID", &SteamServer::getServerSteamID);
 	ClassDB::bind_method(D_METHOD("getSteamID32", "steam_id"), &SteamServer::getSteamID32);
 	ClassDB::bind_method(D_METHOD("isAnonAccount", "steam_id"), &SteamServer::isAnonAccount);
@@ -4226,31 +7318,52 @@ void SteamServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("isIndividualAccount", "steam_id"), &SteamServer::isIndividualAccount);
 	ClassDB::bind_method(D_METHOD("isLobby", "steam_id"), &SteamServer::isLobby);
 	ClassDB::bind_method("isServerSecure", &SteamServer::isServerSecure);
+	ClassDB::bind_method("pollEvents", &SteamServer::pollEvents);
+	ClassDB::bind_method("resetCallResultMetrics", &SteamServer::resetCallResultMetrics);
 	ClassDB::bind_method("run_callbacks", &SteamServer::run_callbacks);
 	ClassDB::bind_method(D_METHOD("serverInit", "ip", "game_port", "query_port", "server_mode", "version_number"), &SteamServer::serverInit);
 	ClassDB::bind_method(D_METHOD("serverInitEx", "ip", "game_port", "query_port", "server_mode", "version_number"), &SteamServer::serverInitEx);
 	ClassDB::bind_method("serverReleaseCurrentThreadMemory", &SteamServer::serverReleaseCurrentThreadMemory);
 	ClassDB::bind_method("serverShutdown", &SteamServer::serverShutdown);
+	ClassDB::bind_method(D_METHOD("setCallbackBudget", "budget_usec"), &SteamServer::setCallbackBudget);
+	ClassDB::bind_method(D_METHOD("setCallbackSubsystems", "subsystems"), &SteamServer::setCallbackSubsystems);
+	ClassDB::bind_method(D_METHOD("setEventQueueEnabled", "enabled"), &SteamServer::setEventQueueEnabled);
+	ClassDB::bind_method(D_METHOD("startCallbackThread", "interval_usec"), &SteamServer::startCallbackThread, DEFVAL(1000));
+	ClassDB::bind_method("stopCallbackThread", &SteamServer::stopCallbackThread);
 
 	// GAME SERVER BIND METHODS /////////////////
 	ClassDB::bind_method(D_METHOD("associateWithClan", "clan_id"), &SteamServer::associateWithClan);
 	ClassDB::bind_method(D_METHOD("beginAuthSession", "ticket", "ticket_size", "steam_id"), &SteamServer::beginAuthSession);
+	ClassDB::bind_method("cancelAllAuthTickets", &SteamServer::cancelAllAuthTickets);
 	ClassDB::bind_method(D_METHOD("cancelAuthTicket", "auth_ticket"), &SteamServer::cancelAuthTicket);
+	ClassDB::bind_method(D_METHOD("cancelAuthTicketsFor", "remote_steam_id"), &SteamServer::cancelAuthTicketsFor);
 	ClassDB::bind_method("clearAllKeyValues", &SteamServer::clearAllKeyValues);
+	ClassDB::bind_method(D_METHOD("clearLicenceCache", "steam_id"), &SteamServer::clearLicenceCache, DEFVAL(0));
+	ClassDB::bind_method("closeQuerySocket", &SteamServer::closeQuerySocket);
 	ClassDB::bind_method(D_METHOD("computeNewPlayerCompatibility", "steam_id"), &SteamServer::computeNewPlayerCompatibility);
 	ClassDB::bind_method(D_METHOD("endAuthSession", "steam_id"), &SteamServer::endAuthSession);
+	ClassDB::bind_method("getAllOutgoingPackets", &SteamServer::getAllOutgoingPackets);
+	ClassDB::bind_method("getAuthSessions", &SteamServer::getAuthSessions);
 	ClassDB::bind_method(D_METHOD("getAuthSessionTicket", "remote_steam_id"), &SteamServer::getAuthSessionTicket, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("getAuthSessionTicketInto", "ticket", "remote_steam_id"), &SteamServer::getAuthSessionTicketInto, DEFVAL(0));
 	ClassDB::bind_method("getNextOutgoingPacket", &SteamServer::getNextOutgoingPacket);
 	ClassDB::bind_method("getPublicIP", &SteamServer::getPublicIP);
+	ClassDB::bind_method("getQuerySocketStats", &SteamServer::getQuerySocketStats);
+	ClassDB::bind_method("getServerInfoStats", &SteamServer::getServerInfoStats);
 	ClassDB::bind_method("getSteamID", &SteamServer::getSteamID);
 	ClassDB::bind_method(D_METHOD("handleIncomingPacket", "packet", "ip", "port"), &SteamServer::handleIncomingPacket);
+	ClassDB::bind_method(D_METHOD("handleIncomingPackets", "data", "offsets", "ips", "ports"), &SteamServer::handleIncomingPackets);
 	ClassDB::bind_method("loggedOn", &SteamServer::loggedOn);
 	ClassDB::bind_method("logOff", &SteamServer::logOff);
 	ClassDB::bind_method(D_METHOD("logOn", "token"), &SteamServer::logOn);
 	ClassDB::bind_method("logOnAnonymous", &SteamServer::logOnAnonymous);
+	ClassDB::bind_method(D_METHOD("openQuerySocket", "port", "bind_ip", "batch_size", "max_packet_size"), &SteamServer::openQuerySocket, DEFVAL(""), DEFVAL(64), DEFVAL(2048));
+	ClassDB::bind_method("pollQuerySocket", &SteamServer::pollQuerySocket);
 	ClassDB::bind_method(D_METHOD("requestUserGroupStatus", "steam_id", "group_id"), &SteamServer::requestUserGroupStatus);
 	ClassDB::bind_method("secure", &SteamServer::secure);
+	ClassDB::bind_method(D_METHOD("sendQuerySocketPackets", "data", "offsets", "ips", "ports"), &SteamServer::sendQuerySocketPackets);
 	ClassDB::bind_method(D_METHOD("setAdvertiseServerActive", "active"), &SteamServer::setAdvertiseServerActive);
+	ClassDB::bind_method(D_METHOD("setAuthSessionPolicy", "policy"), &SteamServer::setAuthSessionPolicy);
 	ClassDB::bind_method(D_METHOD("setBotPlayerCount", "bots"), &SteamServer::setBotPlayerCount);
 	ClassDB::bind_method(D_METHOD("setDedicatedServer", "dedicated"), &SteamServer::setDedicatedServer);
 	ClassDB::bind_method(D_METHOD("setGameData", "data"), &SteamServer::setGameData);
@@ -4262,19 +7375,26 @@ void SteamServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("setModDir", "mod_directory"), &SteamServer::setModDir);
 	ClassDB::bind_method(D_METHOD("setPasswordProtected", "password_protected"), &SteamServer::setPasswordProtected);
 	ClassDB::bind_method(D_METHOD("setProduct", "product"), &SteamServer::setProduct);
+	ClassDB::bind_method(D_METHOD("setQueryPolicy", "policy"), &SteamServer::setQueryPolicy);
 	ClassDB::bind_method(D_METHOD("setRegion", "region"), &SteamServer::setRegion);
+	ClassDB::bind_method(D_METHOD("setServerInfo", "info"), &SteamServer::setServerInfo);
 	ClassDB::bind_method(D_METHOD("setServerName", "name"), &SteamServer::setServerName);
 	ClassDB::bind_method(D_METHOD("setSpectatorPort", "port"), &SteamServer::setSpectatorPort);
 	ClassDB::bind_method(D_METHOD("setSpectatorServerName", "name"), &SteamServer::setSpectatorServerName);
 	ClassDB::bind_method(D_METHOD("userHasLicenceForApp", "steam_id", "app_id"), &SteamServer::userHasLicenceForApp);
+	ClassDB::bind_method(D_METHOD("userHasLicencesForApps", "steam_id", "app_ids"), &SteamServer::userHasLicencesForApps);
 	ClassDB::bind_method("wasRestartRequested", &SteamServer::wasRestartRequested);	
 	
 	// GAME SERVER STATS BIND METHODS ///////////
 	ClassDB::bind_method(D_METHOD("clearUserAchievement", "steam_id", "name"), &SteamServer::clearUserAchievement);
+	ClassDB::bind_method("disableStatsBuffer", &SteamServer::disableStatsBuffer);
+	ClassDB::bind_method(D_METHOD("flushUserStats", "steam_id"), &SteamServer::flushUserStats, DEFVAL(0));
+	ClassDB::bind_method("getStatsBufferStats", &SteamServer::getStatsBufferStats);
 	ClassDB::bind_method(D_METHOD("getUserAchievement", "steam_id", "name"), &SteamServer::getUserAchievement);
 	ClassDB::bind_method(D_METHOD("getUserStatInt", "steam_id", "name"), &SteamServer::getUserStatInt);
 	ClassDB::bind_method(D_METHOD("getUserStatFloat", "steam_id", "name"), &SteamServer::getUserStatFloat);
 	ClassDB::bind_method(D_METHOD("requestUserStats", "steam_id"), &SteamServer::requestUserStats);
+	ClassDB::bind_method(D_METHOD("setStatsBufferPolicy", "policy"), &SteamServer::setStatsBufferPolicy);
 	ClassDB::bind_method(D_METHOD("setUserAchievement", "steam_id", "name"), &SteamServer::setUserAchievement);
 	ClassDB::bind_method(D_METHOD("setUserStatInt", "steam_id", "name", "stat"), &SteamServer::setUserStatInt);
 	ClassDB::bind_method(D_METHOD("setUserStatFloat", "steam_id", "name", "stat"), &SteamServer::setUserStatFloat);
@@ -4357,12 +7477,16 @@ void SteamServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("closeChannelWithUser", "remote_steam_id", "channel"), &SteamServer::closeChannelWithUser);
 	ClassDB::bind_method(D_METHOD("closeSessionWithUser", "remote_steam_id"), &SteamServer::closeSessionWithUser);
 	ClassDB::bind_method(D_METHOD("getSessionConnectionInfo", "remote_steam_id", "get_connection", "get_status"), &SteamServer::getSessionConnectionInfo);
+	ClassDB::bind_method(D_METHOD("receiveMessageObjectsOnChannel", "channel", "max_messages"), &SteamServer::receiveMessageObjectsOnChannel);
 	ClassDB::bind_method(D_METHOD("receiveMessagesOnChannel", "channel", "max_messages"), &SteamServer::receiveMessagesOnChannel);
 	ClassDB::bind_method(D_METHOD("sendMessageToUser", "remote_steam_id", "data", "flags", "channel"), &SteamServer::sendMessageToUser);
 	
 	// NETWORKING SOCKETS BIND METHODS //////////
 	ClassDB::bind_method(D_METHOD("acceptConnection", "connection_handle"), &SteamServer::acceptConnection);
+	ClassDB::bind_method(D_METHOD("addAdmissionBan", "steam_id"), &SteamServer::addAdmissionBan);
 	ClassDB::bind_method(D_METHOD("beginAsyncRequestFakeIP", "num_ports"), &SteamServer::beginAsyncRequestFakeIP);
+	ClassDB::bind_method(D_METHOD("broadcastMessage", "connections", "payload", "flags"), &SteamServer::broadcastMessage);
+	ClassDB::bind_method("clearAdmissionBans", &SteamServer::clearAdmissionBans);
 	ClassDB::bind_method(D_METHOD("closeConnection", "peer", "reason", "debug_message", "linger"), &SteamServer::closeConnection);
 	ClassDB::bind_method(D_METHOD("closeListenSocket", "socket"), &SteamServer::closeListenSocket);
 	ClassDB::bind_method(D_METHOD("configureConnectionLanes", "connection", "lanes", "priorities", "weights"), &SteamServer::configureConnectionLanes);
@@ -4377,13 +7501,26 @@ void SteamServer::_bind_methods() {
 	ClassDB::bind_method("createPollGroup", &SteamServer::createPollGroup);
 	ClassDB::bind_method(D_METHOD("createSocketPair", "loopback", "remote_steam_id1", "remote_steam_id2"), &SteamServer::createSocketPair);
 	ClassDB::bind_method(D_METHOD("destroyPollGroup", "poll_group"), &SteamServer::destroyPollGroup);
+	ClassDB::bind_method("disableAdmissionPolicy", &SteamServer::disableAdmissionPolicy);
+	ClassDB::bind_method(D_METHOD("drainNetworkThread", "max_messages", "unpack"), &SteamServer::drainNetworkThread, DEFVAL(false));
 //	ClassDB::bind_method(D_METHOD("findRelayAuthTicketForServer", "port"), &SteamServer::findRelayAuthTicketForServer);	<------ Uses datagram relay structs which were removed from base SDK
 	ClassDB::bind_method(D_METHOD("flushMessagesOnConnection", "connection_handle"), &SteamServer::flushMessagesOnConnection);
+	ClassDB::bind_method("flushQueuedMessages", &SteamServer::flushQueuedMessages);
+	ClassDB::bind_method("getActiveConnections", &SteamServer::getActiveConnections);
+	ClassDB::bind_method(D_METHOD("getAllConnectionsRealTimeStatus", "lanes"), &SteamServer::getAllConnectionsRealTimeStatus, DEFVAL(0));
 	ClassDB::bind_method("getAuthenticationStatus", &SteamServer::getAuthenticationStatus);		
 	ClassDB::bind_method("getCertificateRequest", &SteamServer::getCertificateRequest);
+	ClassDB::bind_method(D_METHOD("getConnectionBySteamID", "remote_steam_id"), &SteamServer::getConnectionBySteamID);
+	ClassDB::bind_method("getConnectionCount", &SteamServer::getConnectionCount);
 	ClassDB::bind_method(D_METHOD("getConnectionInfo", "connection_handle"), &SteamServer::getConnectionInfo);
 	ClassDB::bind_method(D_METHOD("getConnectionName", "peer"), &SteamServer::getConnectionName);
+	ClassDB::bind_method(D_METHOD("getConnectionPingStats", "connection_handle"), &SteamServer::getConnectionPingStats);
+	ClassDB::bind_method(D_METHOD("getConnectionQualityHistogram", "connection_handle", "buckets"), &SteamServer::getConnectionQualityHistogram, DEFVAL(10));
 	ClassDB::bind_method(D_METHOD("getConnectionRealTimeStatus", "connection_handle", "lanes", "get_status"), &SteamServer::getConnectionRealTimeStatus, DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("getConnectionRecord", "connection_handle"), &SteamServer::getConnectionRecord);
+	ClassDB::bind_method(D_METHOD("getConnectionSamples", "connection_handle", "count"), &SteamServer::getConnectionSamples, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("getConnectionState", "connection_handle"), &SteamServer::getConnectionState);
+	ClassDB::bind_method(D_METHOD("getConnectionSteamID", "connection_handle"), &SteamServer::getConnectionSteamID);
 	ClassDB::bind_method(D_METHOD("getConnectionUserData", "peer"), &SteamServer::getConnectionUserData);
 	ClassDB::bind_method(D_METHOD("getDetailedConnectionStatus", "connection_handle"), &SteamServer::getDetailedConnectionStatus);
 	ClassDB::bind_method(D_METHOD("getFakeIP", "first_port"), &SteamServer::getFakeIP, DEFVAL(0));
@@ -4392,18 +7529,37 @@ void SteamServer::_bind_methods() {
 	ClassDB::bind_method("getHostedDedicatedServerPOPId", &SteamServer::getHostedDedicatedServerPOPId);
 	ClassDB::bind_method("getHostedDedicatedServerPort", &SteamServer::getHostedDedicatedServerPort);
 	ClassDB::bind_method(D_METHOD("getListenSocketAddress", "socket", "with_port"), &SteamServer::getListenSocketAddress, DEFVAL(true));
+	ClassDB::bind_method("getNetworkThreadQueueDepth", &SteamServer::getNetworkThreadQueueDepth);
+	ClassDB::bind_method("getNetworkThreadStatus", &SteamServer::getNetworkThreadStatus);
+	ClassDB::bind_method("getQueuedMessageCount", &SteamServer::getQueuedMessageCount);
 	ClassDB::bind_method(D_METHOD("getRemoteFakeIPForConnection", "connection"), &SteamServer::getRemoteFakeIPForConnection);
 	ClassDB::bind_method("initAuthentication", &SteamServer::initAuthentication);
+	ClassDB::bind_method(D_METHOD("queueMessage", "connection_handle", "data", "flags", "lane"), &SteamServer::queueMessage, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("receiveMessageObjectsOnConnection", "connection", "max_messages"), &SteamServer::receiveMessageObjectsOnConnection);
+	ClassDB::bind_method(D_METHOD("receiveMessageObjectsOnPollGroup", "poll_group", "max_messages"), &SteamServer::receiveMessageObjectsOnPollGroup);
 	ClassDB::bind_method(D_METHOD("receiveMessagesOnConnection", "connection", "max_messages"), &SteamServer::receiveMessagesOnConnection);	
 	ClassDB::bind_method(D_METHOD("receiveMessagesOnPollGroup", "poll_group", "max_messages"), &SteamServer::receiveMessagesOnPollGroup);
+	ClassDB::bind_method(D_METHOD("receiveMessagesOnPollGroupBatch", "poll_group", "max_messages", "unpack"), &SteamServer::receiveMessagesOnPollGroupBatch, DEFVAL(false));
 //	ClassDB::bind_method("receivedRelayAuthTicket", &SteamServer::receivedRelayAuthTicket);	<------ Uses datagram relay structs which were removed from base SDK
+	ClassDB::bind_method(D_METHOD("removeAdmissionBan", "steam_id"), &SteamServer::removeAdmissionBan);
 	ClassDB::bind_method(D_METHOD("resetIdentity", "remote_steam_id"), &SteamServer::resetIdentity);
 	ClassDB::bind_method("runNetworkingCallbacks", &SteamServer::runNetworkingCallbacks);
 	ClassDB::bind_method(D_METHOD("sendMessages", "messages", "data", "connection_handle", "flags"), &SteamServer::sendMessages);
+	ClassDB::bind_method(D_METHOD("sendMessagesBatch", "connections", "data", "offsets", "sizes", "flags", "lanes"), &SteamServer::sendMessagesBatch, DEFVAL(PackedInt32Array()), DEFVAL(PackedInt32Array()));
 	ClassDB::bind_method(D_METHOD("sendMessageToConnection", "connection_handle", "data", "flags"), &SteamServer::sendMessageToConnection);
+	ClassDB::bind_method(D_METHOD("sendMessageZeroCopy", "connection_handle", "data", "flags", "lane"), &SteamServer::sendMessageZeroCopy, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("setAdmissionPolicy", "policy"), &SteamServer::setAdmissionPolicy);
 	ClassDB::bind_method(D_METHOD("setCertificate", "certificate"), &SteamServer::setCertificate);	
+	ClassDB::bind_method(D_METHOD("setConnectionPacking", "connection_handle", "enabled"), &SteamServer::setConnectionPacking);
 	ClassDB::bind_method(D_METHOD("setConnectionPollGroup", "connection_handle", "poll_group"), &SteamServer::setConnectionPollGroup);
+	ClassDB::bind_method(D_METHOD("setConnectionUserData", "peer", "user_data"), &SteamServer::setConnectionUserData);
 	ClassDB::bind_method(D_METHOD("setConnectionName", "peer", "name"), &SteamServer::setConnectionName);
+	ClassDB::bind_method(D_METHOD("setOutboundFlushMode", "mode"), &SteamServer::setOutboundFlushMode);
+	ClassDB::bind_method(D_METHOD("setOutboundPacking", "enabled", "max_packed_size"), &SteamServer::setOutboundPacking, DEFVAL(1100));
+	ClassDB::bind_method(D_METHOD("startConnectionSampler", "interval_usec", "capacity"), &SteamServer::startConnectionSampler, DEFVAL(1000000), DEFVAL(300));
+	ClassDB::bind_method(D_METHOD("startNetworkThread", "poll_groups", "ring_capacity", "max_messages", "idle_usec"), &SteamServer::startNetworkThread, DEFVAL(4096), DEFVAL(256), DEFVAL(500));
+	ClassDB::bind_method("stopConnectionSampler", &SteamServer::stopConnectionSampler);
+	ClassDB::bind_method("stopNetworkThread", &SteamServer::stopNetworkThread);
 
 	// NETWORKING UTILS BIND METHODS ////////////
 	ClassDB::bind_method(D_METHOD("checkPingDataUpToDate", "max_age_in_seconds"), &SteamServer::checkPingDataUpToDate);
@@ -4521,10 +7677,12 @@ void SteamServer::_bind_methods() {
 	/////////////////////////////////////////////
 	//
 	// STEAMWORKS SIGNALS ///////////////////////
+	ADD_SIGNAL(MethodInfo("call_result_completed", PropertyInfo(Variant::INT, "call_handle"), PropertyInfo(Variant::STRING, "api_name"), PropertyInfo(Variant::BOOL, "io_failure")));
 	ADD_SIGNAL(MethodInfo("steamworks_error", PropertyInfo(Variant::STRING, "failed_signal"), PropertyInfo(Variant::STRING, "io failure")));
 
 	// GAME SERVER SIGNALS //////////////////////
 	ADD_SIGNAL(MethodInfo("associate_clan", PropertyInfo(Variant::INT, "result")));
+	ADD_SIGNAL(MethodInfo("auth_session_timed_out", PropertyInfo(Variant::INT, "steam_id")));
 	ADD_SIGNAL(MethodInfo("client_approved", PropertyInfo(Variant::INT, "steam_id"), PropertyInfo(Variant::INT, "owner_id")));
 	ADD_SIGNAL(MethodInfo("client_denied", PropertyInfo(Variant::INT, "steam_id"), PropertyInfo(Variant::INT, "reason")));
 	ADD_SIGNAL(MethodInfo("client_group_status", PropertyInfo(Variant::INT, "steam_id"), PropertyInfo(Variant::INT, "group_id"), PropertyInfo(Variant::BOOL, "member"), PropertyInfo(Variant::BOOL, "officer")));
@@ -4534,6 +7692,7 @@ void SteamServer::_bind_methods() {
 	ADD_SIGNAL(MethodInfo("server_connect_failure", PropertyInfo(Variant::INT, "result"), PropertyInfo(Variant::BOOL, "retrying")));
 	ADD_SIGNAL(MethodInfo("server_connected"));
 	ADD_SIGNAL(MethodInfo("server_disconnected", PropertyInfo(Variant::INT, "result")));
+	ADD_SIGNAL(MethodInfo("validate_auth_ticket_response", PropertyInfo(Variant::INT, "steam_id"), PropertyInfo(Variant::INT, "response"), PropertyInfo(Variant::INT, "owner_id")));
 	
 	// GAME SERVER STATS SIGNALS ////////////////
 	ADD_SIGNAL(MethodInfo("stats_received", PropertyInfo(Variant::INT, "result"), PropertyInfo(Variant::INT, "steam_id")));
@@ -4562,6 +7721,7 @@ void SteamServer::_bind_methods() {
 	ADD_SIGNAL(MethodInfo("network_messages_session_failed", PropertyInfo(Variant::INT, "reason")));
 
 	// NETWORKING SOCKETS SIGNALS ///////////////
+	ADD_SIGNAL(MethodInfo("admission_summary", PropertyInfo(Variant::PACKED_INT32_ARRAY, "accepted"), PropertyInfo(Variant::PACKED_INT32_ARRAY, "rejected"), PropertyInfo(Variant::PACKED_INT32_ARRAY, "reasons")));
 	ADD_SIGNAL(MethodInfo("network_connection_status_changed", PropertyInfo(Variant::INT, "connect_handle"), PropertyInfo(Variant::DICTIONARY, "connection"), PropertyInfo(Variant::INT, "old_state")));
 	ADD_SIGNAL(MethodInfo("network_authentication_status", PropertyInfo(Variant::INT, "available"), PropertyInfo(Variant::STRING, "debug_message")));
 	ADD_SIGNAL(MethodInfo("fake_ip_result", PropertyInfo(Variant::INT, "result"), PropertyInfo(Variant::INT, "remote_fake_steam_id"), PropertyInfo(Variant::STRING, "fake_ip"), PropertyInfo(Variant::ARRAY, "port_list")));
@@ -4690,6 +7850,13 @@ void SteamServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(ACCOUNT_TYPE_ANON_USER);
 	BIND_ENUM_CONSTANT(ACCOUNT_TYPE_MAX);
 
+	// AdmissionRejectReason Enums
+	BIND_ENUM_CONSTANT(ADMISSION_REJECT_BANNED);
+	BIND_ENUM_CONSTANT(ADMISSION_REJECT_RATE_LIMITED_IP);
+	BIND_ENUM_CONSTANT(ADMISSION_REJECT_RATE_LIMITED_STEAM_ID);
+	BIND_ENUM_CONSTANT(ADMISSION_REJECT_FULL);
+	BIND_ENUM_CONSTANT(ADMISSION_REJECT_ACCEPT_FAILED);
+
 	// AuthSessionResponse Enums
 	BIND_ENUM_CONSTANT(AUTH_SESSION_RESPONSE_OK);
 	BIND_ENUM_CONSTANT(AUTH_SESSION_RESPONSE_USER_NOT_CONNECTED_TO_STEAM);
@@ -4703,6 +7870,11 @@ void SteamServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(AUTH_SESSION_RESPONSE_PUBLISHER_ISSUED_BAN);
 	BIND_ENUM_CONSTANT(AUTH_SESSION_RESPONSE_AUTH_TICKET_NETWORK_IDENTITY_FAILURE);
 
+	// AuthSessionState Enums
+	BIND_ENUM_CONSTANT(AUTH_SESSION_STATE_PENDING);
+	BIND_ENUM_CONSTANT(AUTH_SESSION_STATE_APPROVED);
+	BIND_ENUM_CONSTANT(AUTH_SESSION_STATE_DENIED);
+
 	// BeginAuthSessionResult Enums
 	BIND_ENUM_CONSTANT(BEGIN_AUTH_SESSION_RESULT_OK);
 	BIND_ENUM_CONSTANT(BEGIN_AUTH_SESSION_RESULT_INVALID_TICKET);
@@ -4711,6 +7883,20 @@ void SteamServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(BEGIN_AUTH_SESSION_RESULT_GAME_MISMATCH);
 	BIND_ENUM_CONSTANT(BEGIN_AUTH_SESSION_RESULT_EXPIRED_TICKET);
 
+	// CallbackSubsystem Enums
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_NONE);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_GAME_SERVER);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_STATS);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_HTTP);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_INVENTORY);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_NETWORKING);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_NETWORKING_MESSAGES);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_NETWORKING_SOCKETS);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_NETWORKING_UTILS);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_REMOTE_STORAGE);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_UGC);
+	BIND_BITFIELD_FLAG(CALLBACK_SUBSYSTEM_ALL);
+
 	// DenyReason Enums
 	BIND_ENUM_CONSTANT(DENY_INVALID);
 	BIND_ENUM_CONSTANT(DENY_INVALID_VERSION);
@@ -5041,6 +8227,11 @@ void SteamServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(NETWORKING_SOCKET_DEBUG_OUTPUT_TYPE_EVERYTHING);
 	BIND_ENUM_CONSTANT(NETWORKING_SOCKET_DEBUG_OUTPUT_TYPE_FORCE_32BIT);
 
+	// OutboundFlushMode Enums
+	BIND_ENUM_CONSTANT(OUTBOUND_FLUSH_MANUAL);
+	BIND_ENUM_CONSTANT(OUTBOUND_FLUSH_PROCESS_FRAME);
+	BIND_ENUM_CONSTANT(OUTBOUND_FLUSH_PHYSICS_FRAME);
+
 	// P2PSend Enums
 	BIND_ENUM_CONSTANT(P2P_SEND_UNRELIABLE);
 	BIND_ENUM_CONSTANT(P2P_SEND_UNRELIABLE_NO_DELAY);
@@ -5359,7 +8550,15 @@ void SteamServer::_bind_methods() {
 }
 
 SteamServer::~SteamServer() {
+	stopCallbackThread();
+	stopNetworkThread();
+	stopConnectionSampler();
+	closeQuerySocket();
+	setOutboundFlushMode(OUTBOUND_FLUSH_MANUAL);
+	freeCallResults(true);
 	if (is_init_success) {
+		flushUserStats(0);
+		cancelAllAuthTickets();
 		SteamGameServer_Shutdown();
 	}
 	singleton = NULL;
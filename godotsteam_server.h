@@ -28,10 +28,21 @@
 #include "scene/resources/texture.h"
 #include "core/object/ref_counted.h"
 #include "core/variant/dictionary.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/hash_set.h"
+#include "core/templates/safe_refcount.h"
+#include "scene/main/scene_tree.h"
 //#include "core/method_bind_ext.gen.inc" <---- ????
 
 // Include GodotSteam headers
 #include "godotsteam_server_constants.h"
+#include "godotsteam_server_auth_ticket.h"
+#include "godotsteam_server_network_message.h"
+#include "godotsteam_server_query_socket.h"
 
 // Include some system headers
 #include "map"
@@ -80,6 +91,11 @@ public:
 		AUTH_SESSION_RESPONSE_PUBLISHER_ISSUED_BAN = k_EAuthSessionResponsePublisherIssuedBan,
 		AUTH_SESSION_RESPONSE_AUTH_TICKET_NETWORK_IDENTITY_FAILURE = k_EAuthSessionResponseAuthTicketNetworkIdentityFailure
 	};
+	enum AuthSessionState {
+		AUTH_SESSION_STATE_PENDING,
+		AUTH_SESSION_STATE_APPROVED,
+		AUTH_SESSION_STATE_DENIED
+	};
 	enum BeginAuthSessionResult {
 		// Found in steamclientpublic.h
 		BEGIN_AUTH_SESSION_RESULT_OK = k_EBeginAuthSessionResultOK,
@@ -534,6 +550,32 @@ public:
 		NETWORKING_SOCKET_DEBUG_OUTPUT_TYPE_EVERYTHING = k_ESteamNetworkingSocketsDebugOutputType_Everything,
 		NETWORKING_SOCKET_DEBUG_OUTPUT_TYPE_FORCE_32BIT = k_ESteamNetworkingSocketsDebugOutputType__Force32Bit
 	};
+	enum AdmissionRejectReason {
+		ADMISSION_REJECT_BANNED,
+		ADMISSION_REJECT_RATE_LIMITED_IP,
+		ADMISSION_REJECT_RATE_LIMITED_STEAM_ID,
+		ADMISSION_REJECT_FULL,
+		ADMISSION_REJECT_ACCEPT_FAILED
+	};
+	enum OutboundFlushMode {
+		OUTBOUND_FLUSH_MANUAL,
+		OUTBOUND_FLUSH_PROCESS_FRAME,
+		OUTBOUND_FLUSH_PHYSICS_FRAME
+	};
+	enum CallbackSubsystem {
+		CALLBACK_SUBSYSTEM_NONE = 0,
+		CALLBACK_SUBSYSTEM_GAME_SERVER = (1 << 0),
+		CALLBACK_SUBSYSTEM_STATS = (1 << 1),
+		CALLBACK_SUBSYSTEM_HTTP = (1 << 2),
+		CALLBACK_SUBSYSTEM_INVENTORY = (1 << 3),
+		CALLBACK_SUBSYSTEM_NETWORKING = (1 << 4),
+		CALLBACK_SUBSYSTEM_NETWORKING_MESSAGES = (1 << 5),
+		CALLBACK_SUBSYSTEM_NETWORKING_SOCKETS = (1 << 6),
+		CALLBACK_SUBSYSTEM_NETWORKING_UTILS = (1 << 7),
+		CALLBACK_SUBSYSTEM_REMOTE_STORAGE = (1 << 8),
+		CALLBACK_SUBSYSTEM_UGC = (1 << 9),
+		CALLBACK_SUBSYSTEM_ALL = (1 << 10) - 1
+	};
 
 	// Networking Utils enums {
 	enum NetworkingAvailability {
@@ -756,6 +798,9 @@ public:
 	/////////////////////////////////////////
 	//
 	// Main /////////////////////////////////
+	bool enableManualDispatch(BitField<CallbackSubsystem> subsystems = CALLBACK_SUBSYSTEM_ALL, int budget_usec = 0);
+	BitField<CallbackSubsystem> getCallbackSubsystems();
+	Dictionary getCallResultMetrics();
 	uint64_t getServerSteamID();
 	uint32_t getSteamID32(uint64_t steam_id);
 	bool isAnonAccount(uint64_t steam_id);
@@ -766,31 +811,52 @@ public:
 	bool isIndividualAccount(uint64_t steam_id);
 	bool isLobby(uint64_t steam_id);
 	bool isServerSecure();
+	Dictionary pollEvents();
+	void resetCallResultMetrics();
 	bool serverInit(const String& ip, uint16 game_port, uint16 query_port, ServerMode server_mode, const String& version_number);
 	Dictionary serverInitEx(const String& ip, uint16 game_port, uint16 query_port, ServerMode server_mode, const String& version_number);
 	void serverReleaseCurrentThreadMemory();
 	void serverShutdown();
+	void setCallbackBudget(int budget_usec);
+	void setCallbackSubsystems(BitField<CallbackSubsystem> subsystems);
+	void setEventQueueEnabled(bool enabled);
+	bool startCallbackThread(int interval_usec = 1000);
+	void stopCallbackThread();
 	void steamworksError(const String& failed_signal);
 
 	// Game Server //////////////////////////
 	void associateWithClan(uint64_t clan_id);
 	uint32 beginAuthSession(PackedByteArray ticket, int ticket_size, uint64_t steam_id);
+	int cancelAllAuthTickets();
 	void cancelAuthTicket(uint32_t auth_ticket);
+	int cancelAuthTicketsFor(uint64_t remote_steam_id);
 	void clearAllKeyValues();
+	void clearLicenceCache(uint64_t steam_id = 0);
+	void closeQuerySocket();
 	void computeNewPlayerCompatibility(uint64_t steam_id);
 	void endAuthSession(uint64_t steam_id);
+	Dictionary getAllOutgoingPackets();
+	Dictionary getAuthSessions();
 	Dictionary getAuthSessionTicket(uint64_t remote_steam_id = 0);
+	bool getAuthSessionTicketInto(Ref<SteamServerAuthTicket> ticket, uint64_t remote_steam_id = 0);
 	Dictionary getNextOutgoingPacket();
 	Dictionary getPublicIP();
+	Dictionary getQuerySocketStats();
+	Dictionary getServerInfoStats();
 	uint64_t getSteamID();
 	Dictionary handleIncomingPacket(int packet, const String& ip, uint16 port);
+	int handleIncomingPackets(const PackedByteArray data, PackedInt32Array offsets, PackedInt32Array ips, PackedInt32Array ports);
 	bool loggedOn();
 	void logOff();
 	void logOn(const String& token);
 	void logOnAnonymous();
+	bool openQuerySocket(uint16 port, const String& bind_ip = "", int batch_size = 64, int max_packet_size = 2048);
+	Dictionary pollQuerySocket();
 	bool requestUserGroupStatus(uint64_t steam_id, int group_id);
 	bool secure();
+	int sendQuerySocketPackets(const PackedByteArray data, PackedInt32Array offsets, PackedInt32Array ips, PackedInt32Array ports);
 	void setAdvertiseServerActive(bool active);
+	void setAuthSessionPolicy(Dictionary policy);
 	void setBotPlayerCount(int bots);
 	void setDedicatedServer(bool dedicated);
 	void setGameData(const String& data);
@@ -802,19 +868,26 @@ public:
 	void setModDir(const String& mod_directory);
 	void setPasswordProtected(bool password_protected);
 	void setProduct(const String& product);
+	void setQueryPolicy(Dictionary policy);
 	void setRegion(const String& region);
+	int setServerInfo(Dictionary info);
 	void setServerName(const String& name);
 	void setSpectatorPort(uint16 port);
 	void setSpectatorServerName(const String& name);
 	int userHasLicenceForApp(uint64_t steam_id, uint32 app_id);
+	PackedInt32Array userHasLicencesForApps(uint64_t steam_id, PackedInt32Array app_ids);
 	bool wasRestartRequested();
 
 	// Game Server Stats ////////////////////
 	bool clearUserAchievement(uint64_t steam_id, const String& name);
+	void disableStatsBuffer();
+	void flushUserStats(uint64_t steam_id = 0);
+	Dictionary getStatsBufferStats();
 	Dictionary getUserAchievement(uint64_t steam_id, const String& name);
 	uint32_t getUserStatInt(uint64_t steam_id, const String& name);
 	float getUserStatFloat(uint64_t steam_id, const String& name);
-	void requestUserStats(uint64_t steam_id);
+	uint64_t requestUserStats(uint64_t steam_id);
+	void setStatsBufferPolicy(Dictionary policy);
 	bool setUserAchievement(uint64_t steam_id, const String& name);
 	bool setUserStatInt(uint64_t steam_id, const String& name, int32 stat);
 	bool setUserStatFloat(uint64_t steam_id, const String& name, float stat);
@@ -868,10 +941,10 @@ public:
 	uint32 getResultTimestamp(int32 this_inventory_handle = 0);
 	int32 grantPromoItems();
 	bool loadItemDefinitions();
-	void requestEligiblePromoItemDefinitionsIDs(uint64_t steam_id);
-	void requestPrices();
+	uint64_t requestEligiblePromoItemDefinitionsIDs(uint64_t steam_id);
+	uint64_t requestPrices();
 	String serializeResult(int32 this_inventory_handle = 0);
-	void startPurchase(const PackedInt64Array items, const PackedInt32Array quantity);
+	uint64_t startPurchase(const PackedInt64Array items, const PackedInt32Array quantity);
 	int32 transferItemQuantity(uint64_t item_id, uint32 quantity, uint64_t item_destination, bool split);
 	int32 triggerItemDrop(uint32 definition);
 	void startUpdateProperties();
@@ -897,12 +970,16 @@ public:
 	bool closeChannelWithUser(uint64_t remote_steam_id, int channel);
 	bool closeSessionWithUser(uint64_t remote_steam_id);
 	Dictionary getSessionConnectionInfo(uint64_t remote_steam_id, bool get_connection, bool get_status);
+	Array receiveMessageObjectsOnChannel(int channel, int max_messages);
 	Array receiveMessagesOnChannel(int channel, int max_messages);
 	int sendMessageToUser(uint64_t remote_steam_id, const PackedByteArray data, int flags, int channel);
 	
 	// Networking Sockets ///////////////////
 	int acceptConnection(uint32 connection_handle);
+	void addAdmissionBan(uint64_t steam_id);
 	bool beginAsyncRequestFakeIP(int num_ports);
+	PackedInt64Array broadcastMessage(PackedInt32Array connections, const PackedByteArray payload, int flags);
+	void clearAdmissionBans();
 	bool closeConnection(uint32 peer, int reason, const String& debug_message, bool linger);
 	bool closeListenSocket(uint32 socket);
 	int configureConnectionLanes(uint32 connection, int lanes, Array priorities, Array weights);
@@ -917,13 +994,26 @@ public:
 	uint32 createPollGroup();
 	Dictionary createSocketPair(bool loopback, uint64_t remote_steam_id1, uint64_t remote_steam_id2);
 	bool destroyPollGroup(uint32 poll_group);
+	void disableAdmissionPolicy();
+	Dictionary drainNetworkThread(int max_messages, bool unpack = false);
 //		int findRelayAuthTicketForServer(int port);	<------ Uses datagram relay structs which were removed from base SDK
 	int flushMessagesOnConnection(uint32 connection_handle);
+	int flushQueuedMessages();
+	Dictionary getActiveConnections();
+	Dictionary getAllConnectionsRealTimeStatus(int lanes = 0);
 	NetworkingAvailability getAuthenticationStatus();
 	Dictionary getCertificateRequest();
+	uint32 getConnectionBySteamID(uint64_t remote_steam_id);
+	int getConnectionCount();
 	Dictionary getConnectionInfo(uint32 connection_handle);
 	String getConnectionName(uint32 peer);
+	Dictionary getConnectionPingStats(uint32 connection_handle);
+	PackedInt32Array getConnectionQualityHistogram(uint32 connection_handle, int buckets = 10);
 	Dictionary getConnectionRealTimeStatus(uint32 connection_handle, int lanes, bool get_status = true);
+	Dictionary getConnectionRecord(uint32 connection_handle);
+	Dictionary getConnectionSamples(uint32 connection_handle, int count = 0);
+	NetworkingConnectionState getConnectionState(uint32 connection_handle);
+	uint64_t getConnectionSteamID(uint32 connection_handle);
 	uint64_t getConnectionUserData(uint32 peer);
 	Dictionary getDetailedConnectionStatus(uint32 connection_handle);
 	Dictionary getFakeIP(int first_port = 0);
@@ -932,18 +1022,37 @@ public:
 	uint32 getHostedDedicatedServerPOPId();
 	uint16 getHostedDedicatedServerPort();
 	String getListenSocketAddress(uint32 socket, bool with_port = true);
+	int getNetworkThreadQueueDepth();
+	Dictionary getNetworkThreadStatus();
+	int getQueuedMessageCount();
 	Dictionary getRemoteFakeIPForConnection(uint32 connection);
 	NetworkingAvailability initAuthentication();
+	bool queueMessage(uint32 connection_handle, const PackedByteArray data, int flags, int lane = 0);
+	Array receiveMessageObjectsOnConnection(uint32 connection, int max_messages);
+	Array receiveMessageObjectsOnPollGroup(uint32 poll_group, int max_messages);
 	Array receiveMessagesOnConnection(uint32 connection, int max_messages);
 	Array receiveMessagesOnPollGroup(uint32 poll_group, int max_messages);
+	Dictionary receiveMessagesOnPollGroupBatch(uint32 poll_group, int max_messages, bool unpack = false);
 //		Dictionary receivedRelayAuthTicket();	<------ Uses datagram relay structs which were removed from base SDK
+	void removeAdmissionBan(uint64_t steam_id);
 	void resetIdentity(uint64_t remote_steam_id);
 	void runNetworkingCallbacks();
 	void sendMessages(int messages, const PackedByteArray data, uint32 connection_handle, int flags);
+	PackedInt64Array sendMessagesBatch(PackedInt32Array connections, const PackedByteArray data, PackedInt32Array offsets, PackedInt32Array sizes, PackedInt32Array flags = PackedInt32Array(), PackedInt32Array lanes = PackedInt32Array());
 	Dictionary sendMessageToConnection(uint32 connection_handle, const PackedByteArray data, int flags);
+	Dictionary sendMessageZeroCopy(uint32 connection_handle, const PackedByteArray data, int flags, int lane = 0);
+	void setAdmissionPolicy(Dictionary policy);
 	Dictionary setCertificate(const PackedByteArray& certificate);		
+	bool setConnectionPacking(uint32 connection_handle, bool enabled);
 	bool setConnectionPollGroup(uint32 connection_handle, uint32 poll_group);
 	void setConnectionName(uint32 peer, const String& name);
+	bool setConnectionUserData(uint32 peer, uint64_t user_data);
+	bool setOutboundFlushMode(OutboundFlushMode mode);
+	void setOutboundPacking(bool enabled, int max_packed_size = 1100);
+	bool startConnectionSampler(int interval_usec = 1000000, int capacity = 300);
+	bool startNetworkThread(PackedInt32Array poll_groups, int ring_capacity = 4096, int max_messages = 256, int idle_usec = 500);
+	void stopConnectionSampler();
+	void stopNetworkThread();
 
 	// Networking Utils /////////////////////
 	bool checkPingDataUpToDate(float max_age_in_seconds);
@@ -970,23 +1079,23 @@ public:
 	bool setGlobalConfigValueString(NetworkingConfigValue config, const String& value);
 
 	// UGC //////////////////////////////////
-	void addAppDependency(uint64_t published_file_id, uint32_t app_id);
+	uint64_t addAppDependency(uint64_t published_file_id, uint32_t app_id);
 	bool addContentDescriptor(uint64_t update_handle, int descriptor_id);
-	void addDependency(uint64_t published_file_id, uint64_t child_published_file_id);
+	uint64_t addDependency(uint64_t published_file_id, uint64_t child_published_file_id);
 	bool addExcludedTag(uint64_t query_handle, const String& tag_name);
 	bool addItemKeyValueTag(uint64_t query_handle, const String& key, const String& value);
 	bool addItemPreviewFile(uint64_t query_handle, const String& preview_file, ItemPreviewType type);
 	bool addItemPreviewVideo(uint64_t query_handle, const String& video_id);
-	void addItemToFavorites(uint32_t app_id, uint64_t published_file_id);
+	uint64_t addItemToFavorites(uint32_t app_id, uint64_t published_file_id);
 	bool addRequiredKeyValueTag(uint64_t query_handle, const String& key, const String& value);
 	bool addRequiredTag(uint64_t query_handle, const String& tag_name);
 	bool addRequiredTagGroup(uint64_t query_handle, Array tag_array);
 	bool initWorkshopForGameServer(uint32_t workshop_depot_id);
-	void createItem(uint32 app_id, WorkshopFileType file_type);
+	uint64_t createItem(uint32 app_id, WorkshopFileType file_type);
 	uint64_t createQueryAllUGCRequest(UGCQuery query_type, UGCMatchingUGCType matching_type, uint32_t creator_id, uint32_t consumer_id, uint32 page);
 	uint64_t createQueryUGCDetailsRequest(Array published_file_id);
 	uint64_t createQueryUserUGCRequest(uint64_t steam_id, UserUGCList list_type, UGCMatchingUGCType matching_ugc_type, UserUGCListSortOrder sort_order, uint32_t creator_id, uint32_t consumer_id, uint32 page);
-	void deleteItem(uint64_t published_file_id);
+	uint64_t deleteItem(uint64_t published_file_id);
 	bool downloadItem(uint64_t published_file_id, bool high_priority);
 	Dictionary getItemDownloadInfo(uint64_t published_file_id);
 	Dictionary getItemInstallInfo(uint64_t published_file_id);
@@ -1008,15 +1117,15 @@ public:
 	String getQueryUGCTagDisplayName(uint64_t query_handle, uint32 index, uint32 tag_index);
 	Array getSubscribedItems();
 	Array getUserContentDescriptorPreferences(uint32 max_entries);
-	void getUserItemVote(uint64_t published_file_id);
+	uint64_t getUserItemVote(uint64_t published_file_id);
 	bool releaseQueryUGCRequest(uint64_t query_handle);
-	void removeAppDependency(uint64_t published_file_id, uint32_t app_id);
+	uint64_t removeAppDependency(uint64_t published_file_id, uint32_t app_id);
 	bool removeContentDescriptor(uint64_t update_handle, int descriptor_id);
-	void removeDependency(uint64_t published_file_id, uint64_t child_published_file_id);
-	void removeItemFromFavorites(uint32_t app_id, uint64_t published_file_id);
+	uint64_t removeDependency(uint64_t published_file_id, uint64_t child_published_file_id);
+	uint64_t removeItemFromFavorites(uint32_t app_id, uint64_t published_file_id);
 	bool removeItemKeyValueTags(uint64_t update_handle, const String& key);
 	bool removeItemPreview(uint64_t update_handle, uint32 index);
-	void sendQueryUGCRequest(uint64_t update_handle);
+	uint64_t sendQueryUGCRequest(uint64_t update_handle);
 	bool setAllowCachedResponse(uint64_t update_handle, uint32 max_age_seconds);
 	bool setCloudFileNameFilter(uint64_t update_handle, const String& match_cloud_filename);
 	bool setItemContent(uint64_t update_handle, const String& content_folder);
@@ -1039,20 +1148,20 @@ public:
 	bool setReturnPlaytimeStats(uint64_t query_handle, uint32 days);
 	bool setReturnTotalOnly(uint64_t query_handle, bool return_total_only);
 	bool setSearchText(uint64_t query_handle, const String& search_text);
-	void setUserItemVote(uint64_t published_file_id, bool vote_up);
+	uint64_t setUserItemVote(uint64_t published_file_id, bool vote_up);
 	uint64_t startItemUpdate(uint32_t app_id, uint64_t file_id);
-	void startPlaytimeTracking(Array published_file_ids);
-	void stopPlaytimeTracking(Array published_file_ids);
-	void stopPlaytimeTrackingForAllItems();
-	void getAppDependencies(uint64_t published_file_id);
-	void submitItemUpdate(uint64_t update_handle, const String& change_note);
-	void subscribeItem(uint64_t published_file_id);
+	uint64_t startPlaytimeTracking(Array published_file_ids);
+	uint64_t stopPlaytimeTracking(Array published_file_ids);
+	uint64_t stopPlaytimeTrackingForAllItems();
+	uint64_t getAppDependencies(uint64_t published_file_id);
+	uint64_t submitItemUpdate(uint64_t update_handle, const String& change_note);
+	uint64_t subscribeItem(uint64_t published_file_id);
 	void suspendDownloads(bool suspend);
-	void unsubscribeItem(uint64_t published_file_id);
+	uint64_t unsubscribeItem(uint64_t published_file_id);
 	bool updateItemPreviewFile(uint64_t update_handle, uint32 index, const String& preview_file);
 	bool updateItemPreviewVideo(uint64_t update_handle, uint32 index, const String& video_id);
 	bool showWorkshopEULA();
-	void getWorkshopEULAStatus();
+	uint64_t getWorkshopEULAStatus();
 	bool setTimeCreatedDateRange(uint64_t update_handle, uint32 start, uint32 end);
 	bool setTimeUpdatedDateRange(uint64_t update_handle, uint32 start, uint32 end);
 
@@ -1064,6 +1173,9 @@ private:
 	// Main
 	bool is_init_success;
 
+	void addConnectionSamples(uint32 connection_handle);
+	bool admitConnection(uint32 connection_handle, const SteamNetConnectionInfo_t &info);
+	bool allowAdmissionAttempt(uint64_t key, int max_attempts, SteamNetworkingMicroseconds now);
 	const SteamNetworkingConfigValue_t *convertOptionsArray(Array options);
 	CSteamID createSteamID(uint64_t steam_id, AccountType account_type = AccountType(-1));
 	SteamNetworkingIdentity getIdentityFromSteamID(uint64_t steam_id);
@@ -1074,6 +1186,24 @@ private:
 	SteamNetworkingIPAddr getSteamIPFromString(String ip_string);
 	String getStringFromIP(uint32 ip_address);
 	String getStringFromSteamIP(SteamNetworkingIPAddr this_address);
+	void flush_queued_messages_on_frame();
+	int getLiveConnectionCount(uint64_t steam_id);
+	int getPackedEnvelope(SteamNetworkingMessage_t *message);
+	bool isPackingConnection(uint32 connection_handle);
+	Dictionary packMessageBatch(SteamNetworkingMessage_t **messages, int message_count, bool unpack = false);
+	void releaseDisconnectedPlayer(uint64_t steam_id);
+	void removeConnectionRecord(uint32 connection_handle);
+	void removeSteamIDConnection(uint64_t steam_id, uint32 connection_handle);
+	void updateConnectionRecord(uint32 connection_handle, const SteamNetConnectionInfo_t &info);
+	Array wrapMessageObjects(SteamNetworkingMessage_t **messages, int message_count);
+
+	// Payload kept alive for outgoing messages that point at it instead of owning a copy
+	struct SharedPayload {
+		SafeRefCount refcount;
+		PackedByteArray data;
+	};
+	SteamNetworkingMessage_t *allocateZeroCopyMessage(const PackedByteArray &data, SharedPayload **shared_payload = NULL);
+	static void free_shared_payload(SteamNetworkingMessage_t *message);
 
 	// Inventory
 	SteamInventoryUpdateHandle_t inventory_update_handle;
@@ -1088,11 +1218,388 @@ private:
 	PackedByteArray routing_blob;
 //		SteamDatagramRelayAuthTicket relay_auth_ticket;
 
-	// Run the Steamworks server API callbacks
-	void run_callbacks(){
-		SteamGameServer_RunCallbacks();
+	// Networking I/O thread; the thread is the only producer and the main thread the only consumer of the ring
+	static const int NETWORK_RING_MAX_CAPACITY = 1 << 20;
+	Thread network_thread;
+	SafeFlag network_thread_running;
+	LocalVector<uint32> network_thread_poll_groups;
+	int network_thread_max_messages;
+	int network_thread_idle_usec;
+	SteamNetworkingMessage_t** network_ring;
+	uint32_t network_ring_capacity;
+	SafeNumeric<uint32_t> network_ring_head;
+	SafeNumeric<uint32_t> network_ring_tail;
+	SafeNumeric<uint32_t> network_ring_high_watermark;
+	SafeNumeric<uint32_t> network_ring_full_stalls;
+	SafeNumeric<uint64_t> network_ring_received;
+	static void network_thread_loop(void *user_data);
+
+	// Outbound message queue; payloads are stored back to back in outbound_payload
+	struct QueuedMessage {
+		uint32 connection;
+		int flags;
+		uint16 lane;
+		int offset;
+		int size;
+	};
+	LocalVector<QueuedMessage> outbound_queue;
+	LocalVector<uint8_t> outbound_payload;
+	bool outbound_packing;
+	int outbound_packed_size;
+
+	// Connection registry, kept current from network_connection_status_changed
+	struct ConnectionRecord {
+		uint64_t steam_id;
+		int state;
+		uint32 listen_socket;
+		uint32 poll_group;
+		bool packing;
+		int64 user_data;
+		uint32 remote_ip;
+		uint16 remote_port;
+		SteamNetworkingMicroseconds connect_time;
+	};
+	HashMap<uint32, ConnectionRecord> connection_records;
+	// Every live connection for each remote Steam ID, oldest first
+	HashMap<uint64_t, LocalVector<uint32>> connection_handles_by_steam_id;
+	LocalVector<SteamNetConnectionRealTimeLaneStatus_t> status_lanes;
+
+	// Connection sampler; connection_samples is shared with the sampler thread and guarded by connection_sampler_mutex
+	struct ConnectionSample {
+		SteamNetworkingMicroseconds time;
+		int ping;
+		float local_quality;
+		float remote_quality;
+		float bytes_in_per_second;
+		float bytes_out_per_second;
+		SteamNetworkingMicroseconds queue_time;
+	};
+	struct ConnectionSamples {
+		LocalVector<ConnectionSample> samples;
+		int next;
+		int count;
+	};
+	Thread connection_sampler_thread;
+	SafeFlag connection_sampler_running;
+	Mutex connection_sampler_mutex;
+	int connection_sampler_interval;
+	int connection_sampler_capacity;
+	HashMap<uint32, ConnectionSamples> connection_samples;
+	static void connection_sampler_loop(void *user_data);
+	static const int THREAD_SLEEP_SLICE_USEC = 10000;
+
+	// Event queue; compact records stored in place of signals while event_queue_enabled is set
+	enum EventType {
+		EVENT_NETWORK_CONNECTION_STATUS_CHANGED,
+		EVENT_CLIENT_APPROVED,
+		EVENT_CLIENT_DENIED,
+		EVENT_CLIENT_KICK,
+		EVENT_P2P_SESSION_REQUEST,
+		EVENT_NETWORK_MESSAGES_SESSION_REQUEST,
+		EVENT_TYPE_COUNT
+	};
+	struct QueuedEvent {
+		EventType type;
+		uint32 handle;
+		uint64_t steam_id;
+		int value;
+		int old_value;
+		int reason;
+		uint64_t other_id;
+	};
+	bool event_queue_enabled;
+	LocalVector<QueuedEvent> event_queue;
+	void queueEvent(EventType type, uint32 handle = 0, uint64_t steam_id = 0, int value = 0, int old_value = 0, int reason = 0, uint64_t other_id = 0);
+
+	// Callback thread; callback_mutex guards the native tables the callbacks write to
+	static const uint32_t CALLBACK_SIGNAL_RING_SIZE = 4096;
+	struct CallbackSignal {
+		StringName name;
+		LocalVector<Variant> arguments;
+	};
+	Thread callback_thread;
+	SafeFlag callback_thread_running;
+	int callback_thread_interval;
+	Mutex callback_mutex;
+	CallbackSignal *callback_signal_ring[CALLBACK_SIGNAL_RING_SIZE];
+	SafeNumeric<uint32_t> callback_signal_head;
+	SafeNumeric<uint32_t> callback_signal_tail;
+	SafeFlag callback_signal_overflowed;
+	Mutex callback_signal_overflow_mutex;
+	LocalVector<CallbackSignal *> callback_signal_overflow;
+	static void callback_thread_loop(void *user_data);
+	void dispatchCallbackSignals();
+	void emitAdmissionSummary();
+	void emitQueuedSignal(CallbackSignal *callback_signal);
+	void queueCallbackSignal(CallbackSignal *callback_signal);
+
+	// Emit a signal from a callback, queueing it for the main thread if we are on the callback thread
+	template <typename... VarArgs>
+	void emitCallbackSignal(const StringName &name, VarArgs... arguments) {
+		if (!callback_thread_running.is_set() || Thread::get_caller_id() != callback_thread.get_id()) {
+			emit_signal(name, arguments...);
+			return;
+		}
+		const Variant argument_list[sizeof...(arguments) + 1] = { arguments..., Variant() };
+		CallbackSignal *callback_signal = memnew(CallbackSignal);
+		callback_signal->name = name;
+		for (uint32 i = 0; i < sizeof...(arguments); i++) {
+			callback_signal->arguments.push_back(argument_list[i]);
+		}
+		queueCallbackSignal(callback_signal);
 	}
 
+	// Manual callback dispatch; the table maps a callback ID to its subsystem and handler and ends with a zero entry
+	struct CallbackHandler {
+		int callback_id;
+		uint32_t subsystem;
+		void (*dispatch)(SteamServer *steam_server, void *data, bool io_failure);
+	};
+	static const CallbackHandler CALLBACK_HANDLERS[];
+	SafeFlag manual_dispatch_enabled;
+	SafeNumeric<uint32_t> callback_subsystems;
+	SafeNumeric<uint32_t> callback_budget;
+	static const CallbackHandler *findCallbackHandler(const CallbackHandler *table, int callback_id);
+	void runSteamCallbacks();
+
+	template <typename T, void (SteamServer::*handler)(T *)>
+	static void dispatchCallback(SteamServer *steam_server, void *data, bool io_failure) {
+		(steam_server->*handler)((T *)data);
+	}
+
+	// Call result pool; every in-flight async call gets its own CCallResult, keyed by its SteamAPICall_t
+	class PendingCallResult {
+	public:
+		SteamServer *steam_server;
+		SteamAPICall_t handle;
+		StringName api_name;
+		uint64_t issued_usec;
+		virtual ~PendingCallResult() {}
+		virtual void dispatch(void *data, bool io_failure) = 0;
+	};
+	template <typename T>
+	class PendingCallResultOf : public PendingCallResult {
+	public:
+		void (SteamServer::*handler)(T *, bool);
+		CCallResult<PendingCallResultOf<T>, T> call_result;
+		void dispatch(void *data, bool io_failure) override {
+			on_call_result((T *)data, io_failure);
+		}
+		void on_call_result(T *call_data, bool io_failure) {
+			(steam_server->*handler)(call_data, io_failure);
+			steam_server->finishCallResult(this, io_failure);
+		}
+	};
+	HashMap<uint64_t, PendingCallResult *> call_results;
+	LocalVector<PendingCallResult *> finished_call_results;
+
+	// Latency and failure counts for each API that issues call results
+	static const int CALL_RESULT_LATENCY_BUCKETS = 10;
+	static const uint64_t CALL_RESULT_LATENCY_LIMITS[CALL_RESULT_LATENCY_BUCKETS - 1];
+	struct CallResultMetrics {
+		uint32_t in_flight = 0;
+		uint64_t completed = 0;
+		uint64_t io_failures = 0;
+		uint64_t total_latency = 0;
+		uint64_t min_latency = 0;
+		uint64_t max_latency = 0;
+		uint64_t latency_buckets[CALL_RESULT_LATENCY_BUCKETS] = {};
+	};
+	HashMap<StringName, CallResultMetrics> call_result_metrics;
+	void finishCallResult(PendingCallResult *pending, bool io_failure);
+	void freeCallResults(bool pending_too);
+
+	// Register a handler for one async call; any number of calls of the same type can be in flight at once.
+	// Callers hold callback_mutex from issuing the call until it is registered, so a callback run cannot see the result before its handler exists
+	template <typename T>
+	SteamAPICall_t trackCallResult(SteamAPICall_t api_call, void (SteamServer::*handler)(T *, bool), const StringName &api_name) {
+		if (api_call == k_uAPICallInvalid) {
+			return k_uAPICallInvalid;
+		}
+		PendingCallResultOf<T> *pending = memnew(PendingCallResultOf<T>);
+		pending->steam_server = this;
+		pending->handle = api_call;
+		pending->api_name = api_name;
+		pending->handler = handler;
+		pending->issued_usec = OS::get_singleton()->get_ticks_usec();
+		MutexLock lock(callback_mutex);
+		pending->call_result.Set(api_call, pending, &PendingCallResultOf<T>::on_call_result);
+		call_results.insert(api_call, pending);
+		call_result_metrics[api_name].in_flight++;
+		return api_call;
+	}
+
+	// Auth sessions started by beginAuthSession, keyed by Steam ID
+	struct AuthSession {
+		AuthSessionState state;
+		uint64_t owner_id;
+		int response;
+		uint64_t start_usec;
+	};
+	HashMap<uint64_t, AuthSession> auth_sessions;
+	uint64_t auth_session_pending_timeout;
+	bool auth_session_end_on_disconnect;
+	void endTrackedAuthSession(uint64_t steam_id);
+	void expireAuthSessions();
+
+	// Reused by getAllOutgoingPackets so draining the master server packets does not allocate per packet
+	static const int OUTGOING_PACKET_SCRATCH_SIZE = 16 * 1024;
+	LocalVector<uint8_t> outgoing_packet_scratch;
+	PackedByteArray outgoing_packet_batch;
+	LocalVector<SteamServerQuerySocket::Packet> outgoing_packet_list;
+	int drainOutgoingPackets();
+
+	// Native game / query socket for GameSocketShare mode
+	static const int QUERY_SOCKET_MAX_BATCHES = 16;
+	SteamServerQuerySocket query_socket;
+	uint64_t query_socket_query_packets;
+	uint64_t query_socket_game_packets;
+	uint64_t query_socket_replies;
+	uint64_t query_socket_cached_replies;
+	uint64_t query_socket_challenges;
+	uint64_t query_socket_dropped;
+
+	// Last values pushed to the Steam game server, used to build cached query replies
+	struct ServerInfoShadow {
+		String server_name;
+		String map_name;
+		String game_description;
+		String mod_dir;
+		String game_tags;
+		String version;
+		int max_players = 0;
+		int bot_players = 0;
+		int players = -1;
+		bool password_protected = false;
+		bool dedicated = false;
+		uint16 game_port = 0;
+		String game_data;
+		String region;
+		uint16 spectator_port = 0;
+		String spectator_server_name;
+		HashMap<String, String> key_values;
+		uint32 pushed = 0;
+	};
+	enum ServerInfoField {
+		SERVER_INFO_SERVER_NAME = 1 << 0,
+		SERVER_INFO_MAP_NAME = 1 << 1,
+		SERVER_INFO_MAX_PLAYERS = 1 << 2,
+		SERVER_INFO_BOT_PLAYERS = 1 << 3,
+		SERVER_INFO_PASSWORD_PROTECTED = 1 << 4,
+		SERVER_INFO_GAME_TAGS = 1 << 5,
+		SERVER_INFO_GAME_DATA = 1 << 6,
+		SERVER_INFO_REGION = 1 << 7,
+		SERVER_INFO_SPECTATOR_PORT = 1 << 8,
+		SERVER_INFO_SPECTATOR_SERVER_NAME = 1 << 9,
+		SERVER_INFO_KEY_VALUES = 1 << 10
+	};
+	ServerInfoShadow server_info;
+	uint64_t server_info_applied;
+	uint64_t server_info_suppressed;
+	bool serverInfoChanged(uint32 field, bool changed);
+
+	// Cached A2S_INFO / A2S_RULES replies and per-IP query rate limiting
+	static const int QUERY_REPLY_MAX_SIZE = 1400;
+	struct QueryTokenBucket {
+		double tokens = 0.0;
+		uint64_t last_usec = 0;
+	};
+	bool query_cache_enabled;
+	bool query_players_from_auth_sessions;
+	double query_rate;
+	double query_burst;
+	HashMap<uint32, QueryTokenBucket> query_buckets;
+	uint64_t query_bucket_prune_usec;
+	uint32_t query_challenge_secret;
+	LocalVector<uint8_t> query_info_reply;
+	int query_info_player_offset;
+	bool query_info_dirty;
+	uint64_t query_info_steam_id;
+	bool query_info_secure;
+	LocalVector<uint8_t> query_rules_reply;
+	bool query_rules_dirty;
+	LocalVector<uint8_t> query_reply_batch;
+	LocalVector<SteamServerQuerySocket::Packet> query_reply_list;
+	bool takeQueryToken(uint32 ip, uint64_t now);
+	uint32_t getQueryChallenge(uint32 ip);
+	bool handleCachedQuery(const uint8_t *data, uint32 size, uint32 ip, uint16 port, int players);
+	void addQueryReply(const uint8_t *data, uint32 size, uint32 ip, uint16 port);
+	void buildQueryInfoReply();
+	void buildQueryRulesReply();
+
+	// Auth tickets we have handed out and not cancelled yet, with the Steam ID each was made for
+	HashMap<uint32, uint64_t> auth_tickets;
+	int cancelTrackedAuthTickets(uint64_t remote_steam_id, bool all);
+
+	// Licence results from userHasLicenceForApp, keyed by Steam ID then app ID
+	HashMap<uint64_t, HashMap<uint32, int>> licence_cache;
+	int getLicenceResult(uint64_t steam_id, uint32 app_id);
+
+	// Write-behind buffer for stats and achievements, keyed by Steam ID then stat name
+	enum BufferedStatType {
+		BUFFERED_STAT_INT,
+		BUFFERED_STAT_FLOAT,
+		BUFFERED_STAT_ACHIEVEMENT
+	};
+	struct BufferedStat {
+		BufferedStatType type = BUFFERED_STAT_INT;
+		int32 int_value = 0;
+		float float_value = 0.0;
+	};
+	struct StatsBuffer {
+		HashMap<String, BufferedStat> stats;
+		// Names Steam has already accepted for this player, with the type they were checked as
+		HashMap<String, BufferedStatType> validated;
+		bool dirty = false;
+		bool storing = false;
+		int failures = 0;
+		uint64_t dirty_usec = 0;
+		uint64_t last_store_usec = 0;
+		uint64_t retry_usec = 0;
+	};
+	HashMap<uint64_t, StatsBuffer> stats_buffers;
+	bool stats_buffer_enabled;
+	bool stats_flush_on_disconnect;
+	uint64_t stats_flush_interval;
+	uint64_t stats_retry_delay;
+	uint64_t stats_retry_max_delay;
+	uint64_t stats_store_timeout;
+	uint64_t stats_buffer_writes;
+	uint64_t stats_buffer_coalesced;
+	uint64_t stats_buffer_stores;
+	uint64_t stats_buffer_store_failures;
+	uint64_t stats_buffer_store_timeouts;
+	uint64_t stats_buffer_flush_failures;
+	bool bufferStat(uint64_t steam_id, const String &name, const BufferedStat &stat);
+	bool validateBufferedStat(uint64_t steam_id, const String &name, BufferedStatType type);
+	const BufferedStat *findBufferedStat(uint64_t steam_id, const String &name);
+	StatsBuffer &getDirtyStatsBuffer(uint64_t steam_id);
+	void flushPlayerStats(uint64_t steam_id, StatsBuffer &buffer, uint64_t now);
+	void flushStatsBuffers(bool force);
+	void retryStatsStore(StatsBuffer &buffer, uint64_t now);
+
+	// Admission policy for incoming connections
+	struct AdmissionWindow {
+		SteamNetworkingMicroseconds start;
+		int attempts;
+	};
+	bool admission_enabled;
+	int admission_max_connections;
+	int admission_max_attempts_per_ip;
+	int admission_max_attempts_per_steam_id;
+	SteamNetworkingMicroseconds admission_rate_window;
+	SteamNetworkingMicroseconds admission_last_prune;
+	uint32 admission_poll_group;
+	int admission_end_reason;
+	HashSet<uint64_t> admission_bans;
+	HashMap<uint64_t, AdmissionWindow> admission_attempts;
+	LocalVector<uint32> admission_accepted;
+	LocalVector<uint32> admission_rejected;
+	LocalVector<int> admission_reject_reasons;
+
+	// Run the Steamworks server API callbacks
+	void run_callbacks();
+
 
 	// STEAM SERVER CALLBACKS
 	/////////////////////////////////////////
@@ -1108,6 +1615,7 @@ private:
 	STEAM_GAMESERVER_CALLBACK(SteamServer, client_group_status, GSClientGroupStatus_t, callbackClientGroupStatus);
 	STEAM_GAMESERVER_CALLBACK(SteamServer, associate_clan, AssociateWithClanResult_t, callbackAssociateClan);
 	STEAM_GAMESERVER_CALLBACK(SteamServer, player_compat, ComputeNewPlayerCompatibilityResult_t, callbackPlayerCompat);
+	STEAM_GAMESERVER_CALLBACK(SteamServer, validate_auth_ticket_response, ValidateAuthTicketResponse_t, callbackValidateAuthTicketResponse);
 
 	// Game Server Stat callbacks ///////////
 	STEAM_GAMESERVER_CALLBACK(SteamServer, stats_stored, GSStatsStored_t, callbackStatsStored);
@@ -1152,70 +1660,49 @@ private:
 	/////////////////////////////////////////
 	//
 	// Game Server Stats call results ///////
-	CCallResult<SteamServer, GSStatsReceived_t> callResultStatReceived;
 	void stats_received(GSStatsReceived_t *call_data, bool io_failure);
 
 	// Inventory call results ///////////////
-	CCallResult<SteamServer, SteamInventoryEligiblePromoItemDefIDs_t> callResultEligiblePromoItemDefIDs;
 	void inventory_eligible_promo_item(SteamInventoryEligiblePromoItemDefIDs_t *call_data, bool io_failure);
-	CCallResult<SteamServer, SteamInventoryRequestPricesResult_t> callResultRequestPrices;
 	void inventory_request_prices_result(SteamInventoryRequestPricesResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, SteamInventoryStartPurchaseResult_t> callResultStartPurchase;
 	void inventory_start_purchase_result(SteamInventoryStartPurchaseResult_t *call_data, bool io_failure);
 
 	// Remote Storage call results //////////
-	CCallResult<SteamServer, RemoteStorageFileReadAsyncComplete_t> callResultFileReadAsyncComplete;
 	void file_read_async_complete(RemoteStorageFileReadAsyncComplete_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoteStorageFileShareResult_t> callResultFileShareResult;
 	void file_share_result(RemoteStorageFileShareResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoteStorageFileWriteAsyncComplete_t> callResultFileWriteAsyncComplete;
 	void file_write_async_complete(RemoteStorageFileWriteAsyncComplete_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoteStorageDownloadUGCResult_t> callResultDownloadUGCResult;
 	void download_ugc_result(RemoteStorageDownloadUGCResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoteStorageUnsubscribePublishedFileResult_t> callResultUnsubscribeItem;
 	void unsubscribe_item(RemoteStorageUnsubscribePublishedFileResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoteStorageSubscribePublishedFileResult_t> callResultSubscribeItem;
 	void subscribe_item(RemoteStorageSubscribePublishedFileResult_t *call_data, bool io_failure);
 
 	// UGC call results /////////////////////
-	CCallResult<SteamServer, AddAppDependencyResult_t> callResultAddAppDependency;
 	void add_app_dependency_result(AddAppDependencyResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, AddUGCDependencyResult_t> callResultAddUGCDependency;
 	void add_ugc_dependency_result(AddUGCDependencyResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, CreateItemResult_t> callResultItemCreate;
 	void item_created(CreateItemResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, GetAppDependenciesResult_t> callResultGetAppDependencies;
 	void get_app_dependencies_result(GetAppDependenciesResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, DeleteItemResult_t> callResultDeleteItem;
 	void item_deleted(DeleteItemResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, GetUserItemVoteResult_t> callResultGetUserItemVote;
 	void get_item_vote_result(GetUserItemVoteResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoveAppDependencyResult_t> callResultRemoveAppDependency;
 	void remove_app_dependency_result(RemoveAppDependencyResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, RemoveUGCDependencyResult_t> callResultRemoveUGCDependency;
 	void remove_ugc_dependency_result(RemoveUGCDependencyResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, SetUserItemVoteResult_t> callResultSetUserItemVote;
 	void set_user_item_vote(SetUserItemVoteResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, StartPlaytimeTrackingResult_t> callResultStartPlaytimeTracking;
 	void start_playtime_tracking(StartPlaytimeTrackingResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, SteamUGCQueryCompleted_t> callResultUGCQueryCompleted;
 	void ugc_query_completed(SteamUGCQueryCompleted_t *call_data, bool io_failure);
-	CCallResult<SteamServer, StopPlaytimeTrackingResult_t> callResultStopPlaytimeTracking;
 	void stop_playtime_tracking(StopPlaytimeTrackingResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, SubmitItemUpdateResult_t> callResultItemUpdate;
 	void item_updated(SubmitItemUpdateResult_t *call_data, bool io_failure);
-	CCallResult<SteamServer, UserFavoriteItemsListChanged_t> callResultFavoriteItemListChanged;
 	void user_favorite_items_list_changed(UserFavoriteItemsListChanged_t *call_data, bool io_failure);
-	CCallResult<SteamServer, WorkshopEULAStatus_t> callResultWorkshopEULAStatus;
 	void workshop_eula_status(WorkshopEULAStatus_t *call_data, bool io_failure);
 };
 
 
 VARIANT_ENUM_CAST(SteamServer::AccountType);
+VARIANT_ENUM_CAST(SteamServer::AdmissionRejectReason);
 VARIANT_ENUM_CAST(SteamServer::AuthSessionResponse);
+VARIANT_ENUM_CAST(SteamServer::AuthSessionState);
 
 VARIANT_ENUM_CAST(SteamServer::BeginAuthSessionResult);
 
+VARIANT_BITFIELD_CAST(SteamServer::CallbackSubsystem);
+
 VARIANT_ENUM_CAST(SteamServer::DenyReason);
 
 VARIANT_ENUM_CAST(SteamServer::FilePathType);
@@ -1245,6 +1732,7 @@ VARIANT_ENUM_CAST(SteamServer::NetworkingGetConfigValueResult);
 VARIANT_ENUM_CAST(SteamServer::NetworkingIdentityType);
 VARIANT_ENUM_CAST(SteamServer::NetworkingSocketsDebugOutputType);
 
+VARIANT_ENUM_CAST(SteamServer::OutboundFlushMode);
 VARIANT_ENUM_CAST(SteamServer::P2PSend);
 VARIANT_ENUM_CAST(SteamServer::P2PSessionError);
 
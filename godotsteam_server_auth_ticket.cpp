@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////
+///// SILENCE STEAMWORKS WARNINGS
+/////////////////////////////////////////////////
+//
+// Turn off MSVC-only warning about strcpy
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning(disable:4996)
+#pragma warning(disable:4828)
+#endif
+
+
+///// HEADER INCLUDES
+/////////////////////////////////////////////////
+//
+// Include GodotSteam Server auth ticket header
+#include "godotsteam_server_auth_ticket.h"
+
+
+///// AUTH TICKET OBJECT
+/////////////////////////////////////////////////
+//
+SteamServerAuthTicket::SteamServerAuthTicket() {
+	buffer.resize(TICKET_CAPACITY);
+	handle = k_HAuthTicketInvalid;
+	size = 0;
+	remote_steam_id = 0;
+}
+
+// Get the buffer for Steam to write a new ticket into; copies it first only if a script is still holding the old one
+uint8_t *SteamServerAuthTicket::getWriteBuffer() {
+	return buffer.ptrw();
+}
+
+// Record the ticket Steam just wrote into the buffer
+void SteamServerAuthTicket::setTicket(uint32_t new_handle, uint32_t new_size, uint64_t new_remote_steam_id) {
+	handle = new_handle;
+	size = new_size;
+	remote_steam_id = new_remote_steam_id;
+}
+
+
+///// TICKET FUNCTIONS
+/////////////////////////////////////////////////
+//
+// Get the whole ticket buffer without copying it; only the first getSize bytes are the ticket.
+PackedByteArray SteamServerAuthTicket::getBuffer() {
+	return buffer;
+}
+
+// Get the ticket handle, which is passed to cancelAuthTicket.
+uint32_t SteamServerAuthTicket::getHandle() {
+	return handle;
+}
+
+// Get the Steam ID the ticket was made for, or 0 if it was made for anyone.
+uint64_t SteamServerAuthTicket::getRemoteSteamID() {
+	return remote_steam_id;
+}
+
+// Get the ticket size in bytes.
+uint32_t SteamServerAuthTicket::getSize() {
+	return size;
+}
+
+// Copy just the ticket into a new byte array.
+PackedByteArray SteamServerAuthTicket::getTicket() {
+	return buffer.slice(0, size);
+}
+
+// Does this object hold a ticket?
+bool SteamServerAuthTicket::isValid() {
+	return handle != k_HAuthTicketInvalid;
+}
+
+
+///// BIND METHODS
+/////////////////////////////////////////////////
+//
+void SteamServerAuthTicket::_bind_methods() {
+	ClassDB::bind_method("getBuffer", &SteamServerAuthTicket::getBuffer);
+	ClassDB::bind_method("getHandle", &SteamServerAuthTicket::getHandle);
+	ClassDB::bind_method("getRemoteSteamID", &SteamServerAuthTicket::getRemoteSteamID);
+	ClassDB::bind_method("getSize", &SteamServerAuthTicket::getSize);
+	ClassDB::bind_method("getTicket", &SteamServerAuthTicket::getTicket);
+	ClassDB::bind_method("isValid", &SteamServerAuthTicket::isValid);
+}
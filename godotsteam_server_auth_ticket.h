@@ -0,0 +1,65 @@
+#ifndef GODOTSTEAM_SERVER_AUTH_TICKET_H
+#define GODOTSTEAM_SERVER_AUTH_TICKET_H
+
+
+// SILENCE STEAMWORKS WARNINGS
+/////////////////////////////////////////////////
+//
+// Turn off MSVC-only warning about strcpy
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning(disable:4996)
+#pragma warning(disable:4828)
+#endif
+
+
+// INCLUDE HEADERS
+/////////////////////////////////////////////////
+//
+// Include INT types header
+#include <inttypes.h>
+
+// Include Steamworks Server API header
+#include "steam/steam_gameserver.h"
+
+// Include Godot headers
+#include "core/object/ref_counted.h"
+
+
+// Reusable holder for an auth session ticket. Its buffer is allocated once and written in place by SteamServer.getAuthSessionTicketInto.
+class SteamServerAuthTicket: public RefCounted {
+	GDCLASS(SteamServerAuthTicket, RefCounted);
+
+
+public:
+
+	static const uint32_t TICKET_CAPACITY = 1024;
+
+	SteamServerAuthTicket();
+
+	// Buffer Steam writes the ticket into; always TICKET_CAPACITY bytes long
+	uint8_t *getWriteBuffer();
+	void setTicket(uint32_t new_handle, uint32_t new_size, uint64_t new_remote_steam_id);
+
+	// TICKET FUNCTIONS
+	/////////////////////////////////////////
+	//
+	PackedByteArray getBuffer();
+	uint32_t getHandle();
+	uint64_t getRemoteSteamID();
+	uint32_t getSize();
+	PackedByteArray getTicket();
+	bool isValid();
+
+protected:
+	static void _bind_methods();
+
+private:
+	PackedByteArray buffer;
+	uint32_t handle;
+	uint32_t size;
+	uint64_t remote_steam_id;
+};
+
+
+#endif // GODOTSTEAM_SERVER_AUTH_TICKET_H
@@ -0,0 +1,224 @@
+/////////////////////////////////////////////////
+///// SILENCE STEAMWORKS WARNINGS
+/////////////////////////////////////////////////
+//
+// Turn off MSVC-only warning about strcpy
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning(disable:4996)
+#pragma warning(disable:4828)
+#endif
+
+
+///// HEADER INCLUDES
+/////////////////////////////////////////////////
+//
+// Include GodotSteam Server network message header
+#include "godotsteam_server_network_message.h"
+
+
+///// NETWORK MESSAGE OBJECT
+/////////////////////////////////////////////////
+//
+SteamServerNetworkMessage::SteamServerNetworkMessage() {
+	message = NULL;
+	read_position = 0;
+}
+
+SteamServerNetworkMessage::~SteamServerNetworkMessage() {
+	release();
+}
+
+// Take ownership of a received message, releasing any message we were already holding
+void SteamServerNetworkMessage::setMessage(SteamNetworkingMessage_t *new_message) {
+	release();
+	message = new_message;
+}
+
+
+///// STREAM PEER FUNCTIONS
+/////////////////////////////////////////////////
+//
+// Received messages are read-only
+Error SteamServerNetworkMessage::put_data(const uint8_t *data, int bytes) {
+	return ERR_UNAVAILABLE;
+}
+
+Error SteamServerNetworkMessage::put_partial_data(const uint8_t *data, int bytes, int &sent) {
+	sent = 0;
+	return ERR_UNAVAILABLE;
+}
+
+// Read exactly the requested number of bytes from the current position, straight out of Steam's buffer
+Error SteamServerNetworkMessage::get_data(uint8_t *buffer, int bytes) {
+	if (bytes > get_available_bytes()) {
+		return ERR_INVALID_PARAMETER;
+	}
+	int received = 0;
+	return get_partial_data(buffer, bytes, received);
+}
+
+// Read up to the requested number of bytes from the current position
+Error SteamServerNetworkMessage::get_partial_data(uint8_t *buffer, int bytes, int &received) {
+	received = 0;
+	int available = get_available_bytes();
+	if (available <= 0) {
+		return ERR_UNAVAILABLE;
+	}
+	if (bytes > available) {
+		bytes = available;
+	}
+	if (bytes > 0) {
+		memcpy(buffer, (const uint8_t *)message->m_pData + read_position, bytes);
+		read_position += bytes;
+		received = bytes;
+	}
+	return OK;
+}
+
+int SteamServerNetworkMessage::get_available_bytes() const {
+	if (message == NULL) {
+		return 0;
+	}
+	return message->m_cbSize - read_position;
+}
+
+
+///// MESSAGE FUNCTIONS
+/////////////////////////////////////////////////
+//
+// Get the channel the message was received on; only used by the Networking Messages API.
+int SteamServerNetworkMessage::getChannel() {
+	if (message == NULL) {
+		return 0;
+	}
+	return message->m_nChannel;
+}
+
+// Get the connection handle the message was received on.
+uint32 SteamServerNetworkMessage::getConnection() {
+	if (message == NULL) {
+		return 0;
+	}
+	return message->m_conn;
+}
+
+// Get the user data associated with the connection when the message was received.
+uint64_t SteamServerNetworkMessage::getConnectionUserData() {
+	if (message == NULL) {
+		return 0;
+	}
+	return (uint64_t)message->m_nConnUserData;
+}
+
+// Get the message flags; for received messages only the reliable bit is valid.
+int SteamServerNetworkMessage::getFlags() {
+	if (message == NULL) {
+		return 0;
+	}
+	return message->m_nFlags;
+}
+
+// Get the Steam ID of the peer that sent the message.
+uint64_t SteamServerNetworkMessage::getIdentity() {
+	if (message == NULL) {
+		return 0;
+	}
+	return message->m_identityPeer.GetSteamID64();
+}
+
+// Get the message number assigned by the sender.
+uint64_t SteamServerNetworkMessage::getMessageNumber() {
+	if (message == NULL) {
+		return 0;
+	}
+	return (uint64_t)message->m_nMessageNumber;
+}
+
+// Copy the whole payload into a new byte array.
+PackedByteArray SteamServerNetworkMessage::getPayload() {
+	return getSlice(0, getSize());
+}
+
+// Get the current read position used by the stream peer functions.
+int SteamServerNetworkMessage::getPosition() {
+	return read_position;
+}
+
+// Get the payload size in bytes.
+int SteamServerNetworkMessage::getSize() {
+	if (message == NULL) {
+		return 0;
+	}
+	return message->m_cbSize;
+}
+
+// Copy part of the payload into a new byte array; the range is clamped to the payload.
+PackedByteArray SteamServerNetworkMessage::getSlice(int offset, int length) {
+	PackedByteArray slice;
+	int size = getSize();
+	if (offset < 0 || offset >= size || length <= 0) {
+		return slice;
+	}
+	if (length > size - offset) {
+		length = size - offset;
+	}
+	slice.resize(length);
+	memcpy(slice.ptrw(), (const uint8_t *)message->m_pData + offset, length);
+	return slice;
+}
+
+// Get the local timestamp of when the message was received.
+uint64_t SteamServerNetworkMessage::getTimeReceived() {
+	if (message == NULL) {
+		return 0;
+	}
+	return (uint64_t)message->m_usecTimeReceived;
+}
+
+// Is this object still holding a message?
+bool SteamServerNetworkMessage::isValid() {
+	return message != NULL;
+}
+
+// Give the message back to Steam now instead of waiting for this object to be freed.
+void SteamServerNetworkMessage::release() {
+	if (message != NULL) {
+		message->Release();
+		message = NULL;
+	}
+	read_position = 0;
+}
+
+// Move the read position used by the stream peer functions.
+void SteamServerNetworkMessage::seek(int position) {
+	if (position < 0) {
+		position = 0;
+	}
+	int size = getSize();
+	if (position > size) {
+		position = size;
+	}
+	read_position = position;
+}
+
+
+///// BIND METHODS
+/////////////////////////////////////////////////
+//
+void SteamServerNetworkMessage::_bind_methods() {
+	ClassDB::bind_method("getChannel", &SteamServerNetworkMessage::getChannel);
+	ClassDB::bind_method("getConnection", &SteamServerNetworkMessage::getConnection);
+	ClassDB::bind_method("getConnectionUserData", &SteamServerNetworkMessage::getConnectionUserData);
+	ClassDB::bind_method("getFlags", &SteamServerNetworkMessage::getFlags);
+	ClassDB::bind_method("getIdentity", &SteamServerNetworkMessage::getIdentity);
+	ClassDB::bind_method("getMessageNumber", &SteamServerNetworkMessage::getMessageNumber);
+	ClassDB::bind_method("getPayload", &SteamServerNetworkMessage::getPayload);
+	ClassDB::bind_method("getPosition", &SteamServerNetworkMessage::getPosition);
+	ClassDB::bind_method("getSize", &SteamServerNetworkMessage::getSize);
+	ClassDB::bind_method(D_METHOD("getSlice", "offset", "length"), &SteamServerNetworkMessage::getSlice);
+	ClassDB::bind_method("getTimeReceived", &SteamServerNetworkMessage::getTimeReceived);
+	ClassDB::bind_method("isValid", &SteamServerNetworkMessage::isValid);
+	ClassDB::bind_method("release", &SteamServerNetworkMessage::release);
+	ClassDB::bind_method(D_METHOD("seek", "position"), &SteamServerNetworkMessage::seek);
+}
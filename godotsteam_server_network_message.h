@@ -0,0 +1,78 @@
+#ifndef GODOTSTEAM_SERVER_NETWORK_MESSAGE_H
+#define GODOTSTEAM_SERVER_NETWORK_MESSAGE_H
+
+
+// SILENCE STEAMWORKS WARNINGS
+/////////////////////////////////////////////////
+//
+// Turn off MSVC-only warning about strcpy
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning(disable:4996)
+#pragma warning(disable:4828)
+#endif
+
+
+// INCLUDE HEADERS
+/////////////////////////////////////////////////
+//
+// Include INT types header
+#include <inttypes.h>
+
+// Include Steamworks Server API header
+#include "steam/steam_gameserver.h"
+
+// Include Godot headers
+#include "core/io/stream_peer.h"
+
+
+// Wraps a received SteamNetworkingMessage_t without copying its payload. The message is released when this object is freed.
+class SteamServerNetworkMessage: public StreamPeer {
+	GDCLASS(SteamServerNetworkMessage, StreamPeer);
+
+
+public:
+
+	SteamServerNetworkMessage();
+	~SteamServerNetworkMessage();
+
+	// Takes ownership of a received message
+	void setMessage(SteamNetworkingMessage_t *new_message);
+
+	// STREAM PEER FUNCTIONS
+	/////////////////////////////////////////
+	//
+	Error put_data(const uint8_t *data, int bytes) override;
+	Error put_partial_data(const uint8_t *data, int bytes, int &sent) override;
+	Error get_data(uint8_t *buffer, int bytes) override;
+	Error get_partial_data(uint8_t *buffer, int bytes, int &received) override;
+	int get_available_bytes() const override;
+
+	// MESSAGE FUNCTIONS
+	/////////////////////////////////////////
+	//
+	int getChannel();
+	uint32 getConnection();
+	uint64_t getConnectionUserData();
+	int getFlags();
+	uint64_t getIdentity();
+	uint64_t getMessageNumber();
+	PackedByteArray getPayload();
+	int getPosition();
+	int getSize();
+	PackedByteArray getSlice(int offset, int length);
+	uint64_t getTimeReceived();
+	bool isValid();
+	void release();
+	void seek(int position);
+
+protected:
+	static void _bind_methods();
+
+private:
+	SteamNetworkingMessage_t *message;
+	int read_position;
+};
+
+
+#endif // GODOTSTEAM_SERVER_NETWORK_MESSAGE_H
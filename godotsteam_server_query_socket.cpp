@@ -0,0 +1,315 @@
+/////////////////////////////////////////////////
+///// SILENCE STEAMWORKS WARNINGS
+/////////////////////////////////////////////////
+//
+// Turn off MSVC-only warning about strcpy
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning(disable:4996)
+#pragma warning(disable:4828)
+#endif
+
+
+///// HEADER INCLUDES
+/////////////////////////////////////////////////
+//
+// Include GodotSteam Server query socket header
+#include "godotsteam_server_query_socket.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+
+///// QUERY SOCKET OBJECT
+/////////////////////////////////////////////////
+//
+SteamServerQuerySocket::SteamServerQuerySocket() {
+	batch_size = 0;
+	packet_size = 0;
+	slot_size = 0;
+	truncated_count = 0;
+#ifdef __linux__
+	socket_fd = -1;
+#endif
+}
+
+SteamServerQuerySocket::~SteamServerQuerySocket() {
+	closeSocket();
+}
+
+// Open a non-blocking UDP socket on the given address and port, with room for new_batch_size packets of up to new_packet_size bytes per receive
+bool SteamServerQuerySocket::openSocket(uint32_t bind_ip, uint16_t port, int new_batch_size, int new_packet_size) {
+	closeSocket();
+	if (new_batch_size <= 0 || new_packet_size <= 0 || new_packet_size > MAX_PACKET_SIZE) {
+		return false;
+	}
+#ifdef __linux__
+	socket_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (socket_fd < 0) {
+		return false;
+	}
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(bind_ip);
+	address.sin_port = htons(port);
+	if (bind(socket_fd, (sockaddr *)&address, sizeof(address)) != 0) {
+		::close(socket_fd);
+		socket_fd = -1;
+		return false;
+	}
+#else
+	net_socket = Ref<NetSocket>(NetSocket::create());
+	IP::Type ip_type = IP::TYPE_IPV4;
+	if (net_socket->open(NetSocket::TYPE_UDP, ip_type) != OK) {
+		net_socket.unref();
+		return false;
+	}
+	net_socket->set_blocking_enabled(false);
+	IPAddress address = IPAddress("*");
+	if (bind_ip != 0) {
+		address = IPAddress((bind_ip >> 24) & 0xFF, (bind_ip >> 16) & 0xFF, (bind_ip >> 8) & 0xFF, bind_ip & 0xFF);
+	}
+	if (net_socket->bind(address, port) != OK) {
+		net_socket->close();
+		net_socket.unref();
+		return false;
+	}
+#endif
+	batch_size = new_batch_size;
+	packet_size = new_packet_size;
+#ifdef __linux__
+	slot_size = packet_size;
+#else
+	// NetSocket does not report truncation everywhere, so each slot has one spare byte and a read that fills it was too big
+	slot_size = packet_size + 1;
+#endif
+	truncated_count = 0;
+	receive_buffer.resize(batch_size * slot_size);
+	packets.reserve(batch_size);
+	packets.clear();
+#ifdef __linux__
+	// Point each receive header at its own slot of the receive buffer once, so receiving never has to set them up again
+	receive_headers.resize(batch_size);
+	receive_vectors.resize(batch_size);
+	receive_addresses.resize(batch_size);
+	for (int i = 0; i < batch_size; i++) {
+		receive_vectors[i].iov_base = receive_buffer.ptr() + i * slot_size;
+		receive_vectors[i].iov_len = slot_size;
+		memset(&receive_headers[i], 0, sizeof(mmsghdr));
+		receive_headers[i].msg_hdr.msg_name = &receive_addresses[i];
+		receive_headers[i].msg_hdr.msg_iov = &receive_vectors[i];
+		receive_headers[i].msg_hdr.msg_iovlen = 1;
+	}
+#endif
+	return true;
+}
+
+// Close the socket; safe to call when it is not open
+void SteamServerQuerySocket::closeSocket() {
+#ifdef __linux__
+	if (socket_fd >= 0) {
+		::close(socket_fd);
+		socket_fd = -1;
+	}
+#else
+	if (net_socket.is_valid()) {
+		net_socket->close();
+		net_socket.unref();
+	}
+#endif
+	packets.clear();
+	batch_size = 0;
+}
+
+bool SteamServerQuerySocket::isOpen() const {
+#ifdef __linux__
+	return socket_fd >= 0;
+#else
+	return net_socket.is_valid();
+#endif
+}
+
+
+int SteamServerQuerySocket::getBatchSize() const {
+	return batch_size;
+}
+
+
+int SteamServerQuerySocket::getPacketSize() const {
+	return packet_size;
+}
+
+// How many datagrams were dropped for being bigger than the packet size since the socket was opened
+uint64_t SteamServerQuerySocket::getTruncatedCount() const {
+	return truncated_count;
+}
+
+
+///// RECEIVING
+/////////////////////////////////////////////////
+//
+// Receive whatever is waiting, up to one batch. Packets are stored at fixed slots of the receive buffer and stay valid until the next receive.
+// Returns how many datagrams were read, including oversized ones that were dropped, so a full batch means more may be waiting.
+int SteamServerQuerySocket::receivePackets() {
+	packets.clear();
+	if (!isOpen()) {
+		return 0;
+	}
+#ifdef __linux__
+	for (int i = 0; i < batch_size; i++) {
+		receive_headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		receive_headers[i].msg_hdr.msg_flags = 0;
+	}
+	int received = recvmmsg(socket_fd, receive_headers.ptr(), batch_size, MSG_DONTWAIT, NULL);
+	if (received <= 0) {
+		return 0;
+	}
+	for (int i = 0; i < received; i++) {
+		if (receive_headers[i].msg_hdr.msg_flags & MSG_TRUNC) {
+			truncated_count++;
+			continue;
+		}
+		Packet packet;
+		packet.offset = i * slot_size;
+		packet.size = receive_headers[i].msg_len;
+		packet.ip = ntohl(receive_addresses[i].sin_addr.s_addr);
+		packet.port = ntohs(receive_addresses[i].sin_port);
+		packets.push_back(packet);
+	}
+	return received;
+#else
+	int received = 0;
+	for (int i = 0; i < batch_size; i++) {
+		int read = 0;
+		IPAddress address;
+		uint16_t port = 0;
+		Error result = net_socket->recvfrom(receive_buffer.ptr() + i * slot_size, slot_size, read, address, port);
+		// Windows refuses oversized datagrams with an error rather than truncating them
+		if (result == ERR_OUT_OF_MEMORY) {
+			received++;
+			truncated_count++;
+			continue;
+		}
+		if (result != OK) {
+			break;
+		}
+		received++;
+		if (read > packet_size) {
+			truncated_count++;
+			continue;
+		}
+		if (read <= 0 || !address.is_ipv4()) {
+			continue;
+		}
+		const uint8_t *ipv4 = address.get_ipv4();
+		Packet packet;
+		packet.offset = i * slot_size;
+		packet.size = read;
+		packet.ip = ((uint32_t)ipv4[0] << 24) | ((uint32_t)ipv4[1] << 16) | ((uint32_t)ipv4[2] << 8) | (uint32_t)ipv4[3];
+		packet.port = port;
+		packets.push_back(packet);
+	}
+	return received;
+#endif
+}
+
+int SteamServerQuerySocket::getPacketCount() const {
+	return packets.size();
+}
+
+const SteamServerQuerySocket::Packet &SteamServerQuerySocket::getPacket(int index) const {
+	return packets[index];
+}
+
+const uint8_t *SteamServerQuerySocket::getPacketData(int index) const {
+	return receive_buffer.ptr() + packets[index].offset;
+}
+
+
+///// SENDING
+/////////////////////////////////////////////////
+//
+// Send one packet
+bool SteamServerQuerySocket::sendPacket(const uint8_t *data, int size, uint32_t ip, uint16_t port) {
+	if (!isOpen() || size <= 0) {
+		return false;
+	}
+#ifdef __linux__
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(ip);
+	address.sin_port = htons(port);
+	return sendto(socket_fd, data, size, MSG_DONTWAIT, (sockaddr *)&address, sizeof(address)) == size;
+#else
+	int sent = 0;
+	IPAddress address((ip >> 24) & 0xFF, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF);
+	return net_socket->sendto(data, size, sent, address, port) == OK && sent == size;
+#endif
+}
+
+// Send a batch of packets stored back to back in data; on Linux the whole batch goes out in one sendmmsg call.
+// A packet that fails is skipped, and only a full send buffer stops the batch early.
+int SteamServerQuerySocket::sendPackets(const uint8_t *data, const Packet *packet_list, int count) {
+	if (!isOpen() || count <= 0) {
+		return 0;
+	}
+#ifdef __linux__
+	send_headers.resize(count);
+	send_vectors.resize(count);
+	send_addresses.resize(count);
+	for (int i = 0; i < count; i++) {
+		memset(&send_addresses[i], 0, sizeof(sockaddr_in));
+		send_addresses[i].sin_family = AF_INET;
+		send_addresses[i].sin_addr.s_addr = htonl(packet_list[i].ip);
+		send_addresses[i].sin_port = htons(packet_list[i].port);
+		send_vectors[i].iov_base = (void *)(data + packet_list[i].offset);
+		send_vectors[i].iov_len = packet_list[i].size;
+		memset(&send_headers[i], 0, sizeof(mmsghdr));
+		send_headers[i].msg_hdr.msg_name = &send_addresses[i];
+		send_headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		send_headers[i].msg_hdr.msg_iov = &send_vectors[i];
+		send_headers[i].msg_hdr.msg_iovlen = 1;
+	}
+	int next = 0;
+	int sent = 0;
+	while (next < count) {
+		int result = sendmmsg(socket_fd, send_headers.ptr() + next, count - next, MSG_DONTWAIT);
+		if (result > 0) {
+			next += result;
+			sent += result;
+			continue;
+		}
+		if (result == 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+			break;
+		}
+		// sendmmsg stops at the first packet that fails, so step over it
+		next++;
+	}
+	return sent;
+#else
+	int sent = 0;
+	for (int i = 0; i < count; i++) {
+		const Packet &packet = packet_list[i];
+		if (packet.size == 0) {
+			continue;
+		}
+		int packet_sent = 0;
+		IPAddress address((packet.ip >> 24) & 0xFF, (packet.ip >> 16) & 0xFF, (packet.ip >> 8) & 0xFF, packet.ip & 0xFF);
+		Error result = net_socket->sendto(data + packet.offset, packet.size, packet_sent, address, packet.port);
+		if (result == ERR_BUSY) {
+			break;
+		}
+		if (result == OK && packet_sent == (int)packet.size) {
+			sent++;
+		}
+	}
+	return sent;
+#endif
+}
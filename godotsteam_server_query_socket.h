@@ -0,0 +1,92 @@
+#ifndef GODOTSTEAM_SERVER_QUERY_SOCKET_H
+#define GODOTSTEAM_SERVER_QUERY_SOCKET_H
+
+
+// SILENCE STEAMWORKS WARNINGS
+/////////////////////////////////////////////////
+//
+// Turn off MSVC-only warning about strcpy
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning(disable:4996)
+#pragma warning(disable:4828)
+#endif
+
+
+// INCLUDE HEADERS
+/////////////////////////////////////////////////
+//
+// Include INT types header
+#include <inttypes.h>
+
+// Include Godot headers
+#include "core/io/net_socket.h"
+#include "core/templates/local_vector.h"
+
+// Linux receives and sends whole batches in one system call
+#ifdef __linux__
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+
+// Non-blocking UDP socket that SteamServer owns in GameSocketShare mode. Packets are received in batches into one reusable buffer.
+// IP addresses are IPv4 in host order, the same as the Steamworks game server functions use.
+class SteamServerQuerySocket {
+
+public:
+
+	// Default size of each receive slot, and the largest UDP payload a slot can be sized for; datagrams bigger than the slot are dropped
+	static const int DEFAULT_PACKET_SIZE = 2048;
+	static const int MAX_PACKET_SIZE = 65507;
+
+	struct Packet {
+		uint32_t offset;
+		uint32_t size;
+		uint32_t ip;
+		uint16_t port;
+	};
+
+	SteamServerQuerySocket();
+	~SteamServerQuerySocket();
+
+	bool openSocket(uint32_t bind_ip, uint16_t port, int new_batch_size, int new_packet_size = DEFAULT_PACKET_SIZE);
+	void closeSocket();
+	bool isOpen() const;
+	int getBatchSize() const;
+	int getPacketSize() const;
+	uint64_t getTruncatedCount() const;
+
+	// Receive up to one batch of packets, replacing the previous batch; returns how many datagrams were read
+	int receivePackets();
+	int getPacketCount() const;
+	const Packet &getPacket(int index) const;
+	const uint8_t *getPacketData(int index) const;
+
+	// Send one packet, or a batch of packets stored back to back; returns how many were sent
+	bool sendPacket(const uint8_t *data, int size, uint32_t ip, uint16_t port);
+	int sendPackets(const uint8_t *data, const Packet *packet_list, int count);
+
+private:
+	int batch_size;
+	int packet_size;
+	int slot_size;
+	uint64_t truncated_count;
+	LocalVector<uint8_t> receive_buffer;
+	LocalVector<Packet> packets;
+
+#ifdef __linux__
+	int socket_fd;
+	LocalVector<mmsghdr> receive_headers;
+	LocalVector<iovec> receive_vectors;
+	LocalVector<sockaddr_in> receive_addresses;
+	LocalVector<mmsghdr> send_headers;
+	LocalVector<iovec> send_vectors;
+	LocalVector<sockaddr_in> send_addresses;
+#else
+	Ref<NetSocket> net_socket;
+#endif
+};
+
+
+#endif // GODOTSTEAM_SERVER_QUERY_SOCKET_H
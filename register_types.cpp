@@ -2,12 +2,16 @@
 #include "core/object/class_db.h"
 #include "core/config/engine.h"
 #include "godotsteam_server.h"
+#include "godotsteam_server_auth_ticket.h"
+#include "godotsteam_server_network_message.h"
 
 static SteamServer* SteamServerPtr = NULL;
 
 void initialize_godotsteam_server_module(ModuleInitializationLevel level){
 	if(level == MODULE_INITIALIZATION_LEVEL_SERVERS){
 		ClassDB::register_class<SteamServer>();
+		ClassDB::register_class<SteamServerAuthTicket>();
+		ClassDB::register_class<SteamServerNetworkMessage>();
 		SteamServerPtr = memnew(SteamServer);
 		Engine::get_singleton()->add_singleton(Engine::Singleton("SteamServer", SteamServer::get_singleton()));
 	}